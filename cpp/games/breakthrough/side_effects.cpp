@@ -4,37 +4,33 @@
  */
 #include "side_effects.hpp"
 
-Default::Default() {}
-Default::~Default() {}
-void Default::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &old_cell = environment->board[old_x][old_y];
-    Cell &new_cell = environment->board[new_x][new_y];
-    cell_stack.push({old_cell, old_x, old_y});
-    cell_stack.push({new_cell, new_x, new_y});
+static const int empty = Symbols::get_piece_id("empty");
 
+Default::Default() : SideEffect(SideEffectId::Default) {}
+Default::~Default() {}
+void Default::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Cell &old_cell = environment->cell(old_x, old_y);
     if (old_x == new_x && old_y == new_y)
         return;
 
-    new_cell.piece = old_cell.piece;
-    new_cell.owners = old_cell.owners;
-    new_cell.state = old_cell.state;
-    old_cell.piece = "empty";
-    old_cell.owners = std::vector<std::string>();
-    old_cell.state = nullptr;
+    environment->set_piece(new_x, new_y, old_cell.piece);
+    environment->set_piece(old_x, old_y, empty);
 }
-void Default::operator()(Environment *environment) {
-    int x, y;
-    for (int i = 0; i < 2; i++) {
-        x = std::get<1>(cell_stack.top());
-        y = std::get<2>(cell_stack.top());
-        environment->board[x][y] = std::get<0>(cell_stack.top());
-        cell_stack.pop();
-    }
+void Default::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string Default::get_name() const {
     return "Default";
 }
 
-std::map<std::string, std::shared_ptr<SideEffect>> SideEffects::get_side_effect = {
+void SideEffects::execute(int id, Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    switch (static_cast<SideEffectId>(id)) {
+    case SideEffectId::Default:
+        Default::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    }
+}
+
+const std::map<std::string, std::shared_ptr<const SideEffect>> SideEffects::get_side_effect = {
     {"Default", std::make_shared<Default>()},
 };
@@ -4,13 +4,16 @@
  */
 #include "terminal_conditions.hpp"
 
+static const int black = Symbols::get_player_id("black");
+static const int white = Symbols::get_player_id("white");
+
 NoMovesLeft::NoMovesLeft() {}
 NoMovesLeft::~NoMovesLeft() {}
-bool NoMovesLeft::operator()(Environment *environment) {
+bool NoMovesLeft::operator()(Environment *environment) const {
     if (environment->variables.n_moves_found != 0)
         return false;
 
-    if (environment->current_player == "black") {
+    if (environment->current_player == black) {
         environment->variables.black_score = -1;
         environment->variables.white_score = 1;
     }
@@ -27,16 +30,22 @@ std::string NoMovesLeft::get_name() const {
 
 BlackReachedEnd::BlackReachedEnd() {}
 BlackReachedEnd::~BlackReachedEnd() {}
-bool BlackReachedEnd::operator()(Environment *environment) {
-    for (size_t i = 0; i < environment->board[0].size(); i++) {
-        const std::vector<std::string> &owners = environment->board[environment->board.size() - 1][i].owners;
-        if (!owners.empty() && owners[0] == "black") {
-            environment->variables.black_score = 1;
-            environment->variables.white_score = -1;
-            environment->variables.game_over = true;
-            return true;
+bool BlackReachedEnd::operator()(Environment *environment) const {
+    bool reached_end = false;
+    if (environment->has_bitboards) {
+        reached_end = environment->player_bitboards[black] & environment->row_bitboard(environment->board_size_x - 1);
+    }
+    else {
+        for (int i = 0; !reached_end && i < environment->board_size_y; i++) {
+            reached_end = environment->cell(environment->board_size_x - 1, i).owners & (1u << black);
         }
     }
+    if (reached_end) {
+        environment->variables.black_score = 1;
+        environment->variables.white_score = -1;
+        environment->variables.game_over = true;
+        return true;
+    }
     return false;
 }
 std::string BlackReachedEnd::get_name() const {
@@ -45,23 +54,29 @@ std::string BlackReachedEnd::get_name() const {
 
 WhiteReachedEnd::WhiteReachedEnd() {}
 WhiteReachedEnd::~WhiteReachedEnd() {}
-bool WhiteReachedEnd::operator()(Environment *environment) {
-    for (size_t i = 0; i < environment->board[0].size(); i++) {
-        const std::vector<std::string> &owners = environment->board[0][i].owners;
-        if (!owners.empty() && owners[0] == "white") {
-            environment->variables.black_score = -1;
-            environment->variables.white_score = 1;
-            environment->variables.game_over = true;
-            return true;
+bool WhiteReachedEnd::operator()(Environment *environment) const {
+    bool reached_end = false;
+    if (environment->has_bitboards) {
+        reached_end = environment->player_bitboards[white] & environment->row_bitboard(0);
+    }
+    else {
+        for (int i = 0; !reached_end && i < environment->board_size_y; i++) {
+            reached_end = environment->cell(0, i).owners & (1u << white);
         }
     }
+    if (reached_end) {
+        environment->variables.black_score = -1;
+        environment->variables.white_score = 1;
+        environment->variables.game_over = true;
+        return true;
+    }
     return false;
 }
 std::string WhiteReachedEnd::get_name() const {
     return "WhiteReachedEnd";
 }
 
-std::map<std::string, std::shared_ptr<TerminalCondition>> TerminalConditions::terminal_conditions = {
+const std::map<std::string, std::shared_ptr<const TerminalCondition>> TerminalConditions::terminal_conditions = {
     {"NoMovesLeft", std::make_shared<NoMovesLeft>()},
     {"BlackReachedEnd", std::make_shared<BlackReachedEnd>()},
     {"WhiteReachedEnd", std::make_shared<WhiteReachedEnd>()},
@@ -4,264 +4,319 @@
  */
 #include "predicates.hpp"
 
-True::True() {}
-True::~True() {}
-bool True::operator()(Environment *environment, int x, int y) {
-    return true;
-}
+static const int black = Symbols::get_player_id("black");
+static const int white = Symbols::get_player_id("white");
+
+static const int wPawn = Symbols::get_piece_id("wPawn");
+static const int wKnight = Symbols::get_piece_id("wKnight");
+static const int wBishop = Symbols::get_piece_id("wBishop");
+static const int wRook = Symbols::get_piece_id("wRook");
+static const int wQueen = Symbols::get_piece_id("wQueen");
+static const int wKing = Symbols::get_piece_id("wKing");
+static const int bPawn = Symbols::get_piece_id("bPawn");
+static const int bKnight = Symbols::get_piece_id("bKnight");
+static const int bBishop = Symbols::get_piece_id("bBishop");
+static const int bRook = Symbols::get_piece_id("bRook");
+static const int bQueen = Symbols::get_piece_id("bQueen");
+static const int bKing = Symbols::get_piece_id("bKing");
+
 std::string True::get_name() const {
     return "True";
 }
 
-Empty::Empty() {}
-Empty::~Empty() {}
-bool Empty::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].owners.empty();
-}
 std::string Empty::get_name() const {
     return "Empty";
 }
 
-Opponent::Opponent() {}
-Opponent::~Opponent() {}
-bool Opponent::operator()(Environment *environment, int x, int y) {
-    return !environment->board[x][y].owners.empty() &&
-           environment->board[x][y].owners[0] != environment->current_player;
-}
 std::string Opponent::get_name() const {
     return "Opponent";
 }
 
-WhitePawn::WhitePawn() {}
+WhitePawn::WhitePawn() : Predicate(PredicateId::WhitePawn) {}
 WhitePawn::~WhitePawn() {}
-bool WhitePawn::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "wPawn";
+bool WhitePawn::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == wPawn;
+}
+bool WhitePawn::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string WhitePawn::get_name() const {
     return "WPawn";
 }
 
-WhiteKnight::WhiteKnight() {}
+WhiteKnight::WhiteKnight() : Predicate(PredicateId::WhiteKnight) {}
 WhiteKnight::~WhiteKnight() {}
-bool WhiteKnight::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "wKnight";
+bool WhiteKnight::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == wKnight;
+}
+bool WhiteKnight::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string WhiteKnight::get_name() const {
     return "WKnight";
 }
 
-WhiteBishop::WhiteBishop() {}
+WhiteBishop::WhiteBishop() : Predicate(PredicateId::WhiteBishop) {}
 WhiteBishop::~WhiteBishop() {}
-bool WhiteBishop::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "wBishop";
+bool WhiteBishop::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == wBishop;
+}
+bool WhiteBishop::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string WhiteBishop::get_name() const {
     return "WBishop";
 }
 
-WhiteRook::WhiteRook() {}
+WhiteRook::WhiteRook() : Predicate(PredicateId::WhiteRook) {}
 WhiteRook::~WhiteRook() {}
-bool WhiteRook::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "wRook";
+bool WhiteRook::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == wRook;
+}
+bool WhiteRook::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string WhiteRook::get_name() const {
     return "WRook";
 }
 
-WhiteQueen::WhiteQueen() {}
+WhiteQueen::WhiteQueen() : Predicate(PredicateId::WhiteQueen) {}
 WhiteQueen::~WhiteQueen() {}
-bool WhiteQueen::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "wQueen";
+bool WhiteQueen::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == wQueen;
+}
+bool WhiteQueen::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string WhiteQueen::get_name() const {
     return "WQueen";
 }
 
-WhiteKing::WhiteKing() {}
+WhiteKing::WhiteKing() : Predicate(PredicateId::WhiteKing) {}
 WhiteKing::~WhiteKing() {}
-bool WhiteKing::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "wKing";
+bool WhiteKing::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == wKing;
+}
+bool WhiteKing::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string WhiteKing::get_name() const {
     return "WKing";
 }
 
-BlackPawn::BlackPawn() {}
+BlackPawn::BlackPawn() : Predicate(PredicateId::BlackPawn) {}
 BlackPawn::~BlackPawn() {}
-bool BlackPawn::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "bPawn";
+bool BlackPawn::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == bPawn;
+}
+bool BlackPawn::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string BlackPawn::get_name() const {
     return "BPawn";
 }
 
-BlackKnight::BlackKnight() {}
+BlackKnight::BlackKnight() : Predicate(PredicateId::BlackKnight) {}
 BlackKnight::~BlackKnight() {}
-bool BlackKnight::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "bKnight";
+bool BlackKnight::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == bKnight;
+}
+bool BlackKnight::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string BlackKnight::get_name() const {
     return "BKnight";
 }
 
-BlackBishop::BlackBishop() {}
+BlackBishop::BlackBishop() : Predicate(PredicateId::BlackBishop) {}
 BlackBishop::~BlackBishop() {}
-bool BlackBishop::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "bBishop";
+bool BlackBishop::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == bBishop;
+}
+bool BlackBishop::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string BlackBishop::get_name() const {
     return "BBishop";
 }
 
-BlackRook::BlackRook() {}
+BlackRook::BlackRook() : Predicate(PredicateId::BlackRook) {}
 BlackRook::~BlackRook() {}
-bool BlackRook::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "bRook";
+bool BlackRook::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == bRook;
+}
+bool BlackRook::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string BlackRook::get_name() const {
     return "BRook";
 }
 
-BlackQueen::BlackQueen() {}
+BlackQueen::BlackQueen() : Predicate(PredicateId::BlackQueen) {}
 BlackQueen::~BlackQueen() {}
-bool BlackQueen::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "bQueen";
+bool BlackQueen::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == bQueen;
+}
+bool BlackQueen::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string BlackQueen::get_name() const {
     return "BQueen";
 }
 
-BlackKing::BlackKing() {}
+BlackKing::BlackKing() : Predicate(PredicateId::BlackKing) {}
 BlackKing::~BlackKing() {}
-bool BlackKing::operator()(Environment *environment, int x, int y) {
-    return environment->board[x][y].piece == "bKing";
+bool BlackKing::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).piece == bKing;
+}
+bool BlackKing::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string BlackKing::get_name() const {
     return "BKing";
 }
 
-PawnInitialRow::PawnInitialRow() {}
+PawnInitialRow::PawnInitialRow() : Predicate(PredicateId::PawnInitialRow) {}
 PawnInitialRow::~PawnInitialRow() {}
-bool PawnInitialRow::operator()(Environment *environment, int x, int y) {
-    return (environment->board[x][y].piece == "bPawn" && x == 1) ||
-           (environment->board[x][y].piece == "wPawn" && x == 6);
+bool PawnInitialRow::evaluate(Environment *environment, int x, int y) {
+    return (environment->cell(x, y).piece == bPawn && x == 1) ||
+           (environment->cell(x, y).piece == wPawn && x == 6);
+}
+bool PawnInitialRow::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string PawnInitialRow::get_name() const {
     return "PawnInitialRow";
 }
 
-FinalRow::FinalRow() {}
+FinalRow::FinalRow() : Predicate(PredicateId::FinalRow) {}
 FinalRow::~FinalRow() {}
-bool FinalRow::operator()(Environment *environment, int x, int y) {
-    return (!environment->board[x][y].owners.empty() && environment->board[x][y].owners[0] == "black" && x == 7) ||
-           (!environment->board[x][y].owners.empty() && environment->board[x][y].owners[0] == "white" && x == 0);
+bool FinalRow::evaluate(Environment *environment, int x, int y) {
+    unsigned int owners = environment->cell(x, y).owners;
+    return ((owners & (1u << black)) && x == 7) || ((owners & (1u << white)) && x == 0);
+}
+bool FinalRow::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string FinalRow::get_name() const {
     return "FinalRow";
 }
 
-NotFinalRow::NotFinalRow() {}
+NotFinalRow::NotFinalRow() : Predicate(PredicateId::NotFinalRow) {}
 NotFinalRow::~NotFinalRow() {}
-bool NotFinalRow::operator()(Environment *environment, int x, int y) {
-    return !((!environment->board[x][y].owners.empty() && environment->board[x][y].owners[0] == "black" && x == 7) ||
-             (!environment->board[x][y].owners.empty() && environment->board[x][y].owners[0] == "white" && x == 0));
+bool NotFinalRow::evaluate(Environment *environment, int x, int y) {
+    unsigned int owners = environment->cell(x, y).owners;
+    return !(((owners & (1u << black)) && x == 7) || ((owners & (1u << white)) && x == 0));
+}
+bool NotFinalRow::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string NotFinalRow::get_name() const {
     return "NotFinalRow";
 }
 
-EnPassantable::EnPassantable() {}
+EnPassantable::EnPassantable() : Predicate(PredicateId::EnPassantable) {}
 EnPassantable::~EnPassantable() {}
-bool EnPassantable::operator()(Environment *environment, int x, int y) {
+bool EnPassantable::evaluate(Environment *environment, int x, int y) {
     int en_passant_move_number, en_passant_x, en_passant_y;
     std::tie(en_passant_move_number, en_passant_x, en_passant_y) = environment->variables.en_passant_pawn;
     return en_passant_move_number + 1 == environment->move_count && en_passant_x == x && en_passant_y == y;
 }
+bool EnPassantable::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
 std::string EnPassantable::get_name() const {
     return "EnPassantable";
 }
 
-RightToCastleRight::RightToCastleRight() {}
+RightToCastleRight::RightToCastleRight() : Predicate(PredicateId::RightToCastleRight) {}
 RightToCastleRight::~RightToCastleRight() {}
-bool RightToCastleRight::operator()(Environment *environment, int x, int y) {
-    if (environment->current_player == "black")
+bool RightToCastleRight::evaluate(Environment *environment, int x, int y) {
+    if (environment->current_player == black)
         return !environment->variables.black_king_moved && !environment->variables.black_rook_right_moved;
     else
         return !environment->variables.white_king_moved && !environment->variables.white_rook_right_moved;
 }
+bool RightToCastleRight::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
 std::string RightToCastleRight::get_name() const {
     return "RightToCastleRight";
 }
 
-RightToCastleLeft::RightToCastleLeft() {}
+RightToCastleLeft::RightToCastleLeft() : Predicate(PredicateId::RightToCastleLeft) {}
 RightToCastleLeft::~RightToCastleLeft() {}
-bool RightToCastleLeft::operator()(Environment *environment, int x, int y) {
-    if (environment->current_player == "black")
+bool RightToCastleLeft::evaluate(Environment *environment, int x, int y) {
+    if (environment->current_player == black)
         return !environment->variables.black_king_moved && !environment->variables.black_rook_left_moved;
     else
         return !environment->variables.white_king_moved && !environment->variables.white_rook_left_moved;
 }
+bool RightToCastleLeft::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
 std::string RightToCastleLeft::get_name() const {
     return "RightToCastleLeft";
 }
 
-NotAttacked::NotAttacked() {}
+NotAttacked::NotAttacked() : Predicate(PredicateId::NotAttacked) {}
 NotAttacked::~NotAttacked() {}
-bool NotAttacked::operator()(Environment *environment, int x, int y) {
+bool NotAttacked::evaluate(Environment *environment, int x, int y) {
     return !attacked_by_pawn(environment, x, y) && !attacked_by_knight(environment, x, y) &&
            !attacked_diagonally(environment, x, y) && !attacked_straight(environment, x, y);
 }
+bool NotAttacked::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
 bool NotAttacked::attacked_by_pawn(Environment *environment, int x, int y) {
-    if (environment->current_player == "black") {
+    if (environment->current_player == black) {
         bool attacked = false;
-        attacked |= (environment->contains_cell(x + 1, y - 1) && environment->board[x + 1][y - 1].piece == "wPawn");
-        attacked |= (environment->contains_cell(x + 1, y + 1) && environment->board[x + 1][y + 1].piece == "wPawn");
+        attacked |= (environment->contains_cell(x + 1, y - 1) && environment->cell(x + 1, y - 1).piece == wPawn);
+        attacked |= (environment->contains_cell(x + 1, y + 1) && environment->cell(x + 1, y + 1).piece == wPawn);
         return attacked;
     }
     else {
         bool attacked = false;
-        attacked |= (environment->contains_cell(x - 1, y - 1) && environment->board[x - 1][y - 1].piece == "bPawn");
-        attacked |= (environment->contains_cell(x - 1, y + 1) && environment->board[x - 1][y + 1].piece == "bPawn");
+        attacked |= (environment->contains_cell(x - 1, y - 1) && environment->cell(x - 1, y - 1).piece == bPawn);
+        attacked |= (environment->contains_cell(x - 1, y + 1) && environment->cell(x - 1, y + 1).piece == bPawn);
         return attacked;
     }
 }
 bool NotAttacked::attacked_by_knight(Environment *environment, int x, int y) {
-    std::string opponent_knight = environment->current_player == "black" ? "wKnight" : "bKnight";
+    int opponent_knight = environment->current_player == black ? wKnight : bKnight;
     bool attacked = false;
-    attacked |= (environment->contains_cell(x + 1, y + 2) && environment->board[x + 1][y + 2].piece == opponent_knight);
-    attacked |= (environment->contains_cell(x + 1, y - 2) && environment->board[x + 1][y - 2].piece == opponent_knight);
-    attacked |= (environment->contains_cell(x - 1, y + 2) && environment->board[x - 1][y + 2].piece == opponent_knight);
-    attacked |= (environment->contains_cell(x - 1, y - 2) && environment->board[x - 1][y - 2].piece == opponent_knight);
-    attacked |= (environment->contains_cell(x + 2, y + 1) && environment->board[x + 2][y + 1].piece == opponent_knight);
-    attacked |= (environment->contains_cell(x + 2, y - 1) && environment->board[x + 2][y - 1].piece == opponent_knight);
-    attacked |= (environment->contains_cell(x - 2, y + 1) && environment->board[x - 2][y + 1].piece == opponent_knight);
-    attacked |= (environment->contains_cell(x - 2, y - 1) && environment->board[x - 2][y - 1].piece == opponent_knight);
+    attacked |= (environment->contains_cell(x + 1, y + 2) && environment->cell(x + 1, y + 2).piece == opponent_knight);
+    attacked |= (environment->contains_cell(x + 1, y - 2) && environment->cell(x + 1, y - 2).piece == opponent_knight);
+    attacked |= (environment->contains_cell(x - 1, y + 2) && environment->cell(x - 1, y + 2).piece == opponent_knight);
+    attacked |= (environment->contains_cell(x - 1, y - 2) && environment->cell(x - 1, y - 2).piece == opponent_knight);
+    attacked |= (environment->contains_cell(x + 2, y + 1) && environment->cell(x + 2, y + 1).piece == opponent_knight);
+    attacked |= (environment->contains_cell(x + 2, y - 1) && environment->cell(x + 2, y - 1).piece == opponent_knight);
+    attacked |= (environment->contains_cell(x - 2, y + 1) && environment->cell(x - 2, y + 1).piece == opponent_knight);
+    attacked |= (environment->contains_cell(x - 2, y - 1) && environment->cell(x - 2, y - 1).piece == opponent_knight);
     return attacked;
 }
 bool NotAttacked::attacked_diagonally(Environment *environment, int x, int y) {
-    std::string opponent_bishop = environment->current_player == "black" ? "wBishop" : "bBishop";
-    std::string opponent_queen = environment->current_player == "black" ? "wQueen" : "bQueen";
-    std::vector<std::string> opponents{opponent_bishop, opponent_queen};
+    int opponent_bishop = environment->current_player == black ? wBishop : bBishop;
+    int opponent_queen = environment->current_player == black ? wQueen : bQueen;
+    std::array<int, 2> opponents{opponent_bishop, opponent_queen};
     return attacked_coef(environment, x, y, 1, 1, opponents) || attacked_coef(environment, x, y, 1, -1, opponents) ||
            attacked_coef(environment, x, y, -1, 1, opponents) || attacked_coef(environment, x, y, -1, -1, opponents);
 }
 bool NotAttacked::attacked_straight(Environment *environment, int x, int y) {
-    std::string opponent_rook = environment->current_player == "black" ? "wRook" : "bRook";
-    std::string opponent_queen = environment->current_player == "black" ? "wQueen" : "bQueen";
-    std::vector<std::string> opponents{opponent_rook, opponent_queen};
+    int opponent_rook = environment->current_player == black ? wRook : bRook;
+    int opponent_queen = environment->current_player == black ? wQueen : bQueen;
+    std::array<int, 2> opponents{opponent_rook, opponent_queen};
     return attacked_coef(environment, x, y, 1, 0, opponents) || attacked_coef(environment, x, y, -1, 0, opponents) ||
            attacked_coef(environment, x, y, 0, 1, opponents) || attacked_coef(environment, x, y, 0, -1, opponents);
 }
 bool NotAttacked::attacked_coef(Environment *environment, int x, int y, int x_coef, int y_coef,
-                                const std::vector<std::string> &opponents) {
-    for (int i = 1; i < 8; i++) {
-        if (!environment->contains_cell(x + x_coef * i, y + y_coef * i))
-            break;
-        for (const std::string &opponent : opponents) {
-            if (environment->board[x + x_coef * i][y + y_coef * i].piece == opponent)
+                                const std::array<int, 2> &opponents) {
+    for (int i = 1; environment->contains_cell(x + x_coef * i, y + y_coef * i); i++) {
+        for (int opponent : opponents) {
+            if (environment->cell(x + x_coef * i, y + y_coef * i).piece == opponent)
                 return true;
         }
-        if (!environment->board[x + x_coef * i][y + y_coef * i].owners.empty())
+        if (environment->cell(x + x_coef * i, y + y_coef * i).owners != 0)
             break;
     }
     return false;
@@ -270,7 +325,52 @@ std::string NotAttacked::get_name() const {
     return "NotAttacked";
 }
 
-std::map<std::string, std::shared_ptr<Predicate>> Predicates::get_predicate = {
+bool Predicates::evaluate_out_of_line(int id, Environment *environment, int x, int y) {
+    switch (static_cast<PredicateId>(id)) {
+    case PredicateId::WhitePawn:
+        return WhitePawn::evaluate(environment, x, y);
+    case PredicateId::WhiteKnight:
+        return WhiteKnight::evaluate(environment, x, y);
+    case PredicateId::WhiteBishop:
+        return WhiteBishop::evaluate(environment, x, y);
+    case PredicateId::WhiteRook:
+        return WhiteRook::evaluate(environment, x, y);
+    case PredicateId::WhiteQueen:
+        return WhiteQueen::evaluate(environment, x, y);
+    case PredicateId::WhiteKing:
+        return WhiteKing::evaluate(environment, x, y);
+    case PredicateId::BlackPawn:
+        return BlackPawn::evaluate(environment, x, y);
+    case PredicateId::BlackKnight:
+        return BlackKnight::evaluate(environment, x, y);
+    case PredicateId::BlackBishop:
+        return BlackBishop::evaluate(environment, x, y);
+    case PredicateId::BlackRook:
+        return BlackRook::evaluate(environment, x, y);
+    case PredicateId::BlackQueen:
+        return BlackQueen::evaluate(environment, x, y);
+    case PredicateId::BlackKing:
+        return BlackKing::evaluate(environment, x, y);
+    case PredicateId::PawnInitialRow:
+        return PawnInitialRow::evaluate(environment, x, y);
+    case PredicateId::FinalRow:
+        return FinalRow::evaluate(environment, x, y);
+    case PredicateId::NotFinalRow:
+        return NotFinalRow::evaluate(environment, x, y);
+    case PredicateId::EnPassantable:
+        return EnPassantable::evaluate(environment, x, y);
+    case PredicateId::RightToCastleLeft:
+        return RightToCastleLeft::evaluate(environment, x, y);
+    case PredicateId::RightToCastleRight:
+        return RightToCastleRight::evaluate(environment, x, y);
+    case PredicateId::NotAttacked:
+        return NotAttacked::evaluate(environment, x, y);
+    default:
+        return false;
+    }
+}
+
+const std::map<std::string, std::shared_ptr<const Predicate>> Predicates::get_predicate = {
     {"True", std::make_shared<True>()},
     {"Empty", std::make_shared<Empty>()},
     {"Opponent", std::make_shared<Opponent>()},
@@ -12,9 +12,26 @@
 
 #include "environment.hpp"
 #include "variables.hpp"
+#include <cstdint>
 #include <memory>
 #include <string>
 
+/// @brief The IDs of the side effects in SideEffects::get_side_effect.
+/// @details
+///  Moves refer to side effects by ID, and SideEffects::execute dispatches
+///  on these IDs with a switch instead of a virtual call.
+enum class SideEffectId : uint8_t {
+    Default,
+    PromoteToQueen,
+    PromoteToRook,
+    PromoteToBishop,
+    PromoteToKnight,
+    SetEnPassantable,
+    CastleLeft,
+    CastleRight,
+    MarkMoved,
+};
+
 /// @brief Class to represent user-defined side effect for moves in abstract
 ///  board games.
 /// @author Bjarni Dagur Thor Kárason
@@ -27,7 +44,14 @@ class SideEffect
     ///  (new_x, new_y) in an environment.
     /// @details
     ///  A (x, y) position corresponds to a cell in the environment's board,
-    ///  environment->board[x][y].
+    ///  environment->cell(x, y).
+    ///
+    ///  The board and Variables must only be changed through
+    ///  Environment::set_piece and Environment::set_variable, which record the
+    ///  changes so Environment::undo_move can revert them.
+    ///
+    ///  Side effects keep their body in a static execute function with the same
+    ///  parameters, which SideEffects::execute calls without constructing them.
     ///
     /// @pre The positions (old_x, old_y) and (new_x, new_y) are within the
     ///  environment's bounds.
@@ -40,33 +64,42 @@ class SideEffect
     /// @param new_x the x coordinate the piece is going to.
     /// @param new_y the y coordinate the piece is going to.
     /// @return void
-    virtual void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) = 0;
-    /// @brief Reverses the changes made when this side effect was last
-    ///  executed.
-    virtual void operator()(Environment *environment) = 0;
+    virtual void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const = 0;
     /// @brief Returns the name of the predicate. Useful for debugging.
     /// @return the name of the predicate as std::string.
     virtual std::string get_name() const = 0;
+    /// @brief Returns the side effect's ID, its index in GameDefinition#side_effects.
+    /// @details Moves refer to side effects by ID.
+    ///
+    /// @see SideEffects::execute
+    int get_id() const {
+        return static_cast<int>(id);
+    }
 
   protected:
-    /// @brief Stores the state of the cells and their location before this side
-    ///  effect was executed.
-    std::stack<std::tuple<Cell, int, int>> cell_stack;
+    /// @brief SideEffect constructor.
+    ///
+    /// @param id the side effect's ID.
+    explicit SideEffect(SideEffectId id) : id(id) {}
+
+  private:
+    /// @brief The side effect's ID.
+    SideEffectId id;
 };
 
 /// @brief A default side effect that captures the piece at (new_x, new_y) if any.
+/// @details
+///  Also clears the pawn that could be captured en passant in this move, as
+///  it can no longer be captured after the move.
 /// @author Bjarni Dagur Thor Kárason
 class Default : public SideEffect
 {
   public:
     Default();
     ~Default();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
-
-  private:
-    std::stack<int> stagnation_stack;
 };
 
 /// @brief A side effect that promotes a Pawn to a Queen once it reaches the end
@@ -77,8 +110,8 @@ class PromoteToQueen : public SideEffect
   public:
     PromoteToQueen();
     ~PromoteToQueen();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
 };
 
@@ -90,8 +123,8 @@ class PromoteToRook : public SideEffect
   public:
     PromoteToRook();
     ~PromoteToRook();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
 };
 
@@ -103,8 +136,8 @@ class PromoteToBishop : public SideEffect
   public:
     PromoteToBishop();
     ~PromoteToBishop();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
 };
 
@@ -116,8 +149,8 @@ class PromoteToKnight : public SideEffect
   public:
     PromoteToKnight();
     ~PromoteToKnight();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
 };
 
@@ -128,12 +161,9 @@ class SetEnPassantable : public SideEffect
   public:
     SetEnPassantable();
     ~SetEnPassantable();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
-
-  private:
-    std::stack<std::tuple<int, int, int>> en_passant_stack;
 };
 
 /// @brief A side effect to castle to the right.
@@ -143,8 +173,8 @@ class CastleLeft : public SideEffect
   public:
     CastleLeft();
     ~CastleLeft();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
 };
 
@@ -155,8 +185,8 @@ class CastleRight : public SideEffect
   public:
     CastleRight();
     ~CastleRight();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
 };
 
@@ -167,12 +197,9 @@ class MarkMoved : public SideEffect
   public:
     MarkMoved();
     ~MarkMoved();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
-
-  private:
-    std::stack<std::pair<bool *, bool>> moved_stack;
 };
 
 /// @brief Class to store all side effects to use in game descriptions.
@@ -184,5 +211,17 @@ class SideEffects
     /// @details
     ///  When side effects are referenced in game descriptions they will be
     ///  fetched from this map.
-    static std::map<std::string, std::shared_ptr<SideEffect>> get_side_effect;
+    ///
+    ///  Side effects keep all mutable state in the Environment they act on,
+    ///  so the map is immutable and can be shared by any number of
+    ///  Environment instances and threads.
+    static const std::map<std::string, std::shared_ptr<const SideEffect>> get_side_effect;
+    /// @brief Executes the side effect with ID \p id of moving a piece from
+    ///  (old_x, old_y) to (new_x, new_y) in an environment.
+    /// @details
+    ///  Equivalent to calling SideEffect::operator() of the side effect, but
+    ///  dispatches with a switch on \p id instead of a virtual call.
+    ///
+    /// @see SideEffectId
+    static void execute(int id, Environment *environment, int old_x, int old_y, int new_x, int new_y);
 };
@@ -4,25 +4,34 @@
  */
 #include "predicates.hpp"
 
-False::False() {}
-False::~False() {}
-bool False::operator()(Environment *environment, int x, int y) {
-    return false;
-}
+static const int empty = Symbols::get_piece_id("empty");
+
 std::string False::get_name() const {
     return "False";
 }
 
-LowestUnoccupied::LowestUnoccupied() {}
+LowestUnoccupied::LowestUnoccupied() : Predicate(PredicateId::LowestUnoccupied) {}
 LowestUnoccupied::~LowestUnoccupied() {}
-bool LowestUnoccupied::operator()(Environment *environment, int x, int y) {
-    return !environment->contains_cell(x + 1, y) || environment->board[x + 1][y].piece != "empty";
+bool LowestUnoccupied::evaluate(Environment *environment, int x, int y) {
+    return !environment->contains_cell(x + 1, y) || environment->cell(x + 1, y).piece != empty;
+}
+bool LowestUnoccupied::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
 }
 std::string LowestUnoccupied::get_name() const {
     return "LowestUnoccupied";
 }
 
-std::map<std::string, std::shared_ptr<Predicate>> Predicates::get_predicate = {
+bool Predicates::evaluate_out_of_line(int id, Environment *environment, int x, int y) {
+    switch (static_cast<PredicateId>(id)) {
+    case PredicateId::LowestUnoccupied:
+        return LowestUnoccupied::evaluate(environment, x, y);
+    default:
+        return false;
+    }
+}
+
+const std::map<std::string, std::shared_ptr<const Predicate>> Predicates::get_predicate = {
     {"False", std::make_shared<False>()},
     {"LowestUnoccupied", std::make_shared<LowestUnoccupied>()},
 };
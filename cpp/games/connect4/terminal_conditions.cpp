@@ -4,9 +4,14 @@
  */
 #include "terminal_conditions.hpp"
 
+static const int black = Symbols::get_player_id("black");
+
+static const int wPawn = Symbols::get_piece_id("wPawn");
+static const int bPawn = Symbols::get_piece_id("bPawn");
+
 NoMovesLeft::NoMovesLeft() {}
 NoMovesLeft::~NoMovesLeft() {}
-bool NoMovesLeft::operator()(Environment *environment) {
+bool NoMovesLeft::operator()(Environment *environment) const {
     if (environment->variables.n_moves_found != 0)
         return false;
 
@@ -21,9 +26,17 @@ std::string NoMovesLeft::get_name() const {
 
 FourConnected::FourConnected() {}
 FourConnected::~FourConnected() {}
-bool FourConnected::operator()(Environment *environment) {
-    if (four_straight(environment) || four_vertical(environment)) {
-        if (environment->current_player == "black") {
+bool FourConnected::operator()(Environment *environment) const {
+    bool connected;
+    if (environment->has_bitboards) {
+        connected = four_connected(environment, 0, 1) || four_connected(environment, 1, 0) ||
+                    four_connected(environment, 1, 1) || four_connected(environment, -1, 1);
+    }
+    else {
+        connected = four_straight(environment) || four_vertical(environment);
+    }
+    if (connected) {
+        if (environment->current_player == black) {
             environment->variables.black_score = 1;
             environment->variables.white_score = -1;
         }
@@ -36,13 +49,13 @@ bool FourConnected::operator()(Environment *environment) {
     }
     return false;
 }
-bool FourConnected::four_straight(Environment *environment) {
-    std::string players_piece = environment->current_player == "black" ? "bPawn" : "wPawn";
+bool FourConnected::four_straight(Environment *environment) const {
+    int players_piece = environment->current_player == black ? bPawn : wPawn;
 
-    for (size_t i = 0; i < environment->board.size(); i++) {
+    for (int i = 0; i < environment->board_size_x; i++) {
         int connected = 0;
-        for (size_t j = 0; j < environment->board[0].size(); j++) {
-            if (environment->board[i][j].piece == players_piece)
+        for (int j = 0; j < environment->board_size_y; j++) {
+            if (environment->cell(i, j).piece == players_piece)
                 connected++;
             else
                 connected = 0;
@@ -51,10 +64,10 @@ bool FourConnected::four_straight(Environment *environment) {
         }
     }
 
-    for (size_t i = 0; i < environment->board[0].size(); i++) {
+    for (int i = 0; i < environment->board_size_y; i++) {
         int connected = 0;
-        for (size_t j = 0; j < environment->board.size(); j++) {
-            if (environment->board[j][i].piece == players_piece)
+        for (int j = 0; j < environment->board_size_x; j++) {
+            if (environment->cell(j, i).piece == players_piece)
                 connected++;
             else
                 connected = 0;
@@ -65,17 +78,17 @@ bool FourConnected::four_straight(Environment *environment) {
 
     return false;
 }
-bool FourConnected::four_vertical(Environment *environment) {
-    if (environment->board.size() < 4 || environment->board[0].size() < 4)
+bool FourConnected::four_vertical(Environment *environment) const {
+    if (environment->board_size_x < 4 || environment->board_size_y < 4)
         return false;
 
-    std::string players_piece = environment->current_player == "black" ? "bPawn" : "wPawn";
+    int players_piece = environment->current_player == black ? bPawn : wPawn;
 
-    for (size_t i = 0; i < environment->board.size() - 3; i++) {
-        for (size_t j = 0; j < environment->board[0].size() - 3; j++) {
+    for (int i = 0; i < environment->board_size_x - 3; i++) {
+        for (int j = 0; j < environment->board_size_y - 3; j++) {
             int connected = 0;
             for (int k = 0; k < 4; k++) {
-                if (environment->board[i + k][j + k].piece == players_piece)
+                if (environment->cell(i + k, j + k).piece == players_piece)
                     connected++;
                 else
                     connected = 0;
@@ -85,11 +98,11 @@ bool FourConnected::four_vertical(Environment *environment) {
         }
     }
 
-    for (size_t i = 3; i < environment->board.size(); i++) {
-        for (size_t j = 0; j < environment->board[0].size() - 3; j++) {
+    for (int i = 3; i < environment->board_size_x; i++) {
+        for (int j = 0; j < environment->board_size_y - 3; j++) {
             int connected = 0;
             for (int k = 0; k < 4; k++) {
-                if (environment->board[i - k][j + k].piece == players_piece)
+                if (environment->cell(i - k, j + k).piece == players_piece)
                     connected++;
                 else
                     connected = 0;
@@ -101,11 +114,31 @@ bool FourConnected::four_vertical(Environment *environment) {
 
     return false;
 }
+bool FourConnected::four_connected(Environment *environment, int x_coef, int y_coef) const {
+    int players_piece = environment->current_player == black ? bPawn : wPawn;
+    Bitboard pieces = environment->piece_bitboards[players_piece];
+
+    // The cells from which four cells in the direction (x_coef, y_coef) are on the board.
+    Bitboard starts = 0;
+    for (int i = std::max(0, -3 * x_coef); i < environment->board_size_x - std::max(0, 3 * x_coef); i++) {
+        Bitboard row = environment->row_bitboard(i);
+        starts |= row & (row >> (3 * y_coef));
+    }
+    if (starts == 0)
+        return false;
+
+    int offset = environment->square(x_coef, y_coef);
+    Bitboard connected = pieces & starts;
+    for (int k = 1; k < 4; k++) {
+        connected &= offset > 0 ? pieces >> (k * offset) : pieces << (-k * offset);
+    }
+    return connected != 0;
+}
 std::string FourConnected::get_name() const {
     return "FourConnected";
 }
 
-std::map<std::string, std::shared_ptr<TerminalCondition>> TerminalConditions::terminal_conditions = {
+const std::map<std::string, std::shared_ptr<const TerminalCondition>> TerminalConditions::terminal_conditions = {
     {"NoMovesLeft", std::make_shared<NoMovesLeft>()},
     {"FourConnected", std::make_shared<FourConnected>()},
 };
@@ -4,25 +4,15 @@
  */
 #include "predicates.hpp"
 
-False::False() {}
-False::~False() {}
-bool False::operator()(Environment *environment, int x, int y) {
-    return false;
-}
 std::string False::get_name() const {
     return "False";
 }
 
-True::True() {}
-True::~True() {}
-bool True::operator()(Environment *environment, int x, int y) {
-    return true;
-}
 std::string True::get_name() const {
     return "True";
 }
 
-std::map<std::string, std::shared_ptr<Predicate>> Predicates::get_predicate = {
+const std::map<std::string, std::shared_ptr<const Predicate>> Predicates::get_predicate = {
     {"False", std::make_shared<False>()},
     {"True", std::make_shared<True>()},
 };
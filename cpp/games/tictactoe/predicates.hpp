@@ -12,9 +12,19 @@
 
 #include "environment.hpp"
 #include "variables.hpp"
+#include <cstdint>
 #include <memory>
 #include <string>
 
+/// @brief The IDs of the predicates in Predicates::get_predicate.
+/// @details
+///  Predicates::evaluate dispatches on these IDs with a switch instead of a
+///  virtual call, so the compiler can inline each predicate at its case.
+enum class PredicateId : uint8_t {
+    False,
+    True,
+};
+
 /// @brief Class to represent user-defined predicates for moves in abstract
 ///  board games.
 /// @author Bjarni Dagur Thor Kárason
@@ -26,7 +36,10 @@ class Predicate
     /// @brief Evaluates the predicate at the position (x, y) in an environment.
     /// @details
     ///  The (x, y) position corresponds to cell in the environment's board,
-    ///  environment->board[x][y].
+    ///  environment->cell(x, y).
+    ///
+    ///  Predicates keep their body in a static evaluate function with the same
+    ///  parameters, which Predicates::evaluate calls without constructing them.
     ///
     /// @pre The position (x, y) is within the environment's bounds.
     ///
@@ -37,10 +50,26 @@ class Predicate
     /// @param y the y coordinate to evaluate the predicate at.
     /// @return true if the predicate holds at (x, y).
     /// @return false if the predicate does not hold at (x, y).
-    virtual bool operator()(Environment *environment, int x, int y) = 0;
+    virtual bool operator()(Environment *environment, int x, int y) const = 0;
     /// @brief Returns the name of the predicate. Useful for debugging.
     /// @return the name of the predicate as std::string.
     virtual std::string get_name() const = 0;
+    /// @brief Returns the predicate's ID.
+    ///
+    /// @see Predicates::evaluate
+    int get_id() const {
+        return static_cast<int>(id);
+    }
+
+  protected:
+    /// @brief Predicate constructor.
+    ///
+    /// @param id the predicate's ID.
+    explicit Predicate(PredicateId id) : id(id) {}
+
+  private:
+    /// @brief The predicate's ID.
+    PredicateId id;
 };
 
 /// @brief A predicate that is always false.
@@ -50,7 +79,8 @@ class False : public Predicate
   public:
     False();
     ~False();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -61,7 +91,8 @@ class True : public Predicate
   public:
     True();
     ~True();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -74,5 +105,45 @@ class Predicates
     /// @details
     ///  When predicates are referenced in game descriptions they will be
     ///  fetched from this map.
-    static std::map<std::string, std::shared_ptr<Predicate>> get_predicate;
+    ///
+    ///  Predicates keep no mutable state, so the map is immutable and can be
+    ///  shared by any number of Environment instances and threads.
+    static const std::map<std::string, std::shared_ptr<const Predicate>> get_predicate;
+    /// @brief Evaluates the predicate with ID \p id at the position (x, y) in an environment.
+    /// @details
+    ///  Equivalent to calling Predicate::operator() of the predicate, but
+    ///  dispatches with a switch on \p id instead of a virtual call.
+    ///
+    /// @see PredicateId
+    static bool evaluate(int id, Environment *environment, int x, int y);
 };
+
+// The simplest predicates are defined here so Predicates::evaluate can inline them.
+
+inline False::False() : Predicate(PredicateId::False) {}
+inline False::~False() {}
+inline bool False::evaluate(Environment *environment, int x, int y) {
+    return false;
+}
+inline bool False::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
+
+inline True::True() : Predicate(PredicateId::True) {}
+inline True::~True() {}
+inline bool True::evaluate(Environment *environment, int x, int y) {
+    return true;
+}
+inline bool True::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
+
+inline bool Predicates::evaluate(int id, Environment *environment, int x, int y) {
+    switch (static_cast<PredicateId>(id)) {
+    case PredicateId::False:
+        return False::evaluate(environment, x, y);
+    case PredicateId::True:
+        return True::evaluate(environment, x, y);
+    }
+    return false;
+}
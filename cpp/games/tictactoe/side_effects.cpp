@@ -4,26 +4,31 @@
  */
 #include "side_effects.hpp"
 
-Default::Default() {}
+static const int white = Symbols::get_player_id("white");
+
+static const int piece_x = Symbols::get_piece_id("x");
+static const int piece_o = Symbols::get_piece_id("o");
+
+Default::Default() : SideEffect(SideEffectId::Default) {}
 Default::~Default() {}
-void Default::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &cell = environment->board[new_x][new_y];
-    cell_stack.push({environment->board[new_x][new_y], new_x, new_y});
-    std::string players_piece = environment->current_player == "white" ? "x" : "o";
-    cell.owners = environment->pieces[players_piece].first;
-    cell.piece = players_piece;
-    cell.state = environment->pieces[players_piece].second.get();
+void Default::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    environment->set_piece(new_x, new_y, environment->current_player == white ? piece_x : piece_o);
 }
-void Default::operator()(Environment *environment) {
-    int x = std::get<1>(cell_stack.top());
-    int y = std::get<2>(cell_stack.top());
-    environment->board[x][y] = std::get<0>(cell_stack.top());
-    cell_stack.pop();
+void Default::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string Default::get_name() const {
     return "Default";
 }
 
-std::map<std::string, std::shared_ptr<SideEffect>> SideEffects::get_side_effect = {
+void SideEffects::execute(int id, Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    switch (static_cast<SideEffectId>(id)) {
+    case SideEffectId::Default:
+        Default::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    }
+}
+
+const std::map<std::string, std::shared_ptr<const SideEffect>> SideEffects::get_side_effect = {
     {"Default", std::make_shared<Default>()},
 };
@@ -12,9 +12,18 @@
 
 #include "environment.hpp"
 #include "variables.hpp"
+#include <cstdint>
 #include <memory>
 #include <string>
 
+/// @brief The IDs of the side effects in SideEffects::get_side_effect.
+/// @details
+///  Moves refer to side effects by ID, and SideEffects::execute dispatches
+///  on these IDs with a switch instead of a virtual call.
+enum class SideEffectId : uint8_t {
+    Default,
+};
+
 /// @brief Class to represent user-defined side effect for moves in abstract
 ///  board games.
 /// @author Bjarni Dagur Thor Kárason
@@ -27,7 +36,14 @@ class SideEffect
     ///  (new_x, new_y) in an environment.
     /// @details
     ///  A (x, y) position corresponds to a cell in the environment's board,
-    ///  environment->board[x][y].
+    ///  environment->cell(x, y).
+    ///
+    ///  The board and Variables must only be changed through
+    ///  Environment::set_piece and Environment::set_variable, which record the
+    ///  changes so Environment::undo_move can revert them.
+    ///
+    ///  Side effects keep their body in a static execute function with the same
+    ///  parameters, which SideEffects::execute calls without constructing them.
     ///
     /// @pre The positions (old_x, old_y) and (new_x, new_y) are within the
     ///  environment's bounds.
@@ -40,18 +56,27 @@ class SideEffect
     /// @param new_x the x coordinate the piece is going to.
     /// @param new_y the y coordinate the piece is going to.
     /// @return void
-    virtual void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) = 0;
-    /// @brief Reverses the changes made when this side effect was last
-    ///  executed.
-    virtual void operator()(Environment *environment) = 0;
+    virtual void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const = 0;
     /// @brief Returns the name of the predicate. Useful for debugging.
     /// @return the name of the predicate as std::string.
     virtual std::string get_name() const = 0;
+    /// @brief Returns the side effect's ID, its index in GameDefinition#side_effects.
+    /// @details Moves refer to side effects by ID.
+    ///
+    /// @see SideEffects::execute
+    int get_id() const {
+        return static_cast<int>(id);
+    }
 
   protected:
-    /// @brief Stores the state of the cells and their location before this side
-    ///  effect was executed.
-    std::stack<std::tuple<Cell, int, int>> cell_stack;
+    /// @brief SideEffect constructor.
+    ///
+    /// @param id the side effect's ID.
+    explicit SideEffect(SideEffectId id) : id(id) {}
+
+  private:
+    /// @brief The side effect's ID.
+    SideEffectId id;
 };
 
 /// @brief A default side effect that places a player's piece at (new_x, new_y).
@@ -61,8 +86,8 @@ class Default : public SideEffect
   public:
     Default();
     ~Default();
-    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) override;
-    void operator()(Environment *environment) override;
+    static void execute(Environment *environment, int old_x, int old_y, int new_x, int new_y);
+    void operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const override;
     std::string get_name() const override;
 };
 
@@ -75,5 +100,17 @@ class SideEffects
     /// @details
     ///  When side effects are referenced in game descriptions they will be
     ///  fetched from this map.
-    static std::map<std::string, std::shared_ptr<SideEffect>> get_side_effect;
+    ///
+    ///  Side effects keep all mutable state in the Environment they act on,
+    ///  so the map is immutable and can be shared by any number of
+    ///  Environment instances and threads.
+    static const std::map<std::string, std::shared_ptr<const SideEffect>> get_side_effect;
+    /// @brief Executes the side effect with ID \p id of moving a piece from
+    ///  (old_x, old_y) to (new_x, new_y) in an environment.
+    /// @details
+    ///  Equivalent to calling SideEffect::operator() of the side effect, but
+    ///  dispatches with a switch on \p id instead of a virtual call.
+    ///
+    /// @see SideEffectId
+    static void execute(int id, Environment *environment, int old_x, int old_y, int new_x, int new_y);
 };
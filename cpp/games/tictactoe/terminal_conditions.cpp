@@ -4,9 +4,13 @@
  */
 #include "terminal_conditions.hpp"
 
+static const int black = Symbols::get_player_id("black");
+
+static const int empty = Symbols::get_piece_id("empty");
+
 NoMovesLeft::NoMovesLeft() {}
 NoMovesLeft::~NoMovesLeft() {}
-bool NoMovesLeft::operator()(Environment *environment) {
+bool NoMovesLeft::operator()(Environment *environment) const {
     if (environment->variables.n_moves_found != 0)
         return false;
 
@@ -21,7 +25,7 @@ std::string NoMovesLeft::get_name() const {
 
 ThreeConnected::ThreeConnected() {}
 ThreeConnected::~ThreeConnected() {}
-bool ThreeConnected::operator()(Environment *environment) {
+bool ThreeConnected::operator()(Environment *environment) const {
     bool connected = false;
     for (int i = 0; i < 3; i++) {
         connected |= check_line(environment, 0, i, 1, 0);
@@ -30,7 +34,7 @@ bool ThreeConnected::operator()(Environment *environment) {
     connected |= check_line(environment, 0, 0, 1, 1);
     connected |= check_line(environment, 0, 2, 1, -1);
     if (connected) {
-        if (environment->current_player == "black") {
+        if (environment->current_player == black) {
             environment->variables.black_score = 1;
             environment->variables.white_score = -1;
         }
@@ -43,13 +47,22 @@ bool ThreeConnected::operator()(Environment *environment) {
     }
     return false;
 }
-bool ThreeConnected::check_line(Environment *environment, int x, int y, int x_coef, int y_coef) {
-    if (environment->board[x][y].piece == "empty")
+bool ThreeConnected::check_line(Environment *environment, int x, int y, int x_coef, int y_coef) const {
+    int piece = environment->cell(x, y).piece;
+    if (piece == empty)
         return false;
 
+    if (environment->has_bitboards) {
+        Bitboard line = 0;
+        for (int i = 0; i <= 2; i++) {
+            line |= Bitboard(1) << environment->square(x + i * x_coef, y + i * y_coef);
+        }
+        return (environment->piece_bitboards[piece] & line) == line;
+    }
+
     for (int i = 1; i <= 2; i++) {
-        if (environment->board[x + (i - 1) * x_coef][y + (i - 1) * y_coef].piece !=
-            environment->board[x + i * x_coef][y + i * y_coef].piece) {
+        if (environment->cell(x + (i - 1) * x_coef, y + (i - 1) * y_coef).piece !=
+            environment->cell(x + i * x_coef, y + i * y_coef).piece) {
             return false;
         }
     }
@@ -59,7 +72,7 @@ std::string ThreeConnected::get_name() const {
     return "ThreeConnected";
 }
 
-std::map<std::string, std::shared_ptr<TerminalCondition>> TerminalConditions::terminal_conditions = {
+const std::map<std::string, std::shared_ptr<const TerminalCondition>> TerminalConditions::terminal_conditions = {
     {"NoMovesLeft", std::make_shared<NoMovesLeft>()},
     {"ThreeConnected", std::make_shared<ThreeConnected>()},
 };
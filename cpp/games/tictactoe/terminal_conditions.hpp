@@ -36,7 +36,7 @@ class TerminalCondition
     /// @param environment pointer to an environment to evaluate the terminal condition in.
     /// @return true if the terminal condition holds.
     /// @return false if the terminal condition does not holds.
-    virtual bool operator()(Environment *environment) = 0;
+    virtual bool operator()(Environment *environment) const = 0;
     /// @brief Returns the name of the predicate. Useful for debugging.
     /// @return the name of the predicate as std::string.
     virtual std::string get_name() const = 0;
@@ -49,7 +49,7 @@ class NoMovesLeft : public TerminalCondition
   public:
     NoMovesLeft();
     ~NoMovesLeft();
-    bool operator()(Environment *environment) override;
+    bool operator()(Environment *environment) const override;
     std::string get_name() const override;
 };
 
@@ -60,11 +60,11 @@ class ThreeConnected : public TerminalCondition
   public:
     ThreeConnected();
     ~ThreeConnected();
-    bool operator()(Environment *environment) override;
+    bool operator()(Environment *environment) const override;
     std::string get_name() const override;
 
   private:
-    bool check_line(Environment *environment, int x, int y, int x_coef, int y_coef);
+    bool check_line(Environment *environment, int x, int y, int x_coef, int y_coef) const;
 };
 
 /// @brief Class to store all terminal conditions to use in game descriptions.
@@ -76,5 +76,8 @@ class TerminalConditions
     /// @details
     ///  When terminal conditions are checked they will be fetched from this
     ///  map.
-    static std::map<std::string, std::shared_ptr<TerminalCondition>> terminal_conditions;
+    ///
+    ///  Terminal conditions keep no mutable state, so the map is immutable and can be
+    ///  shared by any number of Environment instances and threads.
+    static const std::map<std::string, std::shared_ptr<const TerminalCondition>> terminal_conditions;
 };
@@ -15,20 +15,43 @@ PYBIND11_MODULE(python_bindings, m) {
     py::class_<Parser>(m, "Parser")
         .def(py::init<std::string>())
         .def("parse", &Parser::parse)
+        .def("get_game_definition",
+             // pybind11 has no holder for pointers to const, and GameDefinition exposes nothing mutable.
+             [](Parser &parser) { return std::const_pointer_cast<GameDefinition>(parser.get_game_definition()); })
         .def("get_environment", &Parser::get_environment);
 
+    py::class_<GameDefinition, std::shared_ptr<GameDefinition>>(m, "GameDefinition")
+        .def_readonly("board_size_x", &GameDefinition::board_size_x)
+        .def_readonly("board_size_y", &GameDefinition::board_size_y);
+
     py::class_<Environment>(m, "Environment")
+        .def(py::init(
+            [](std::shared_ptr<GameDefinition> definition) { return std::make_unique<Environment>(definition); }))
         .def_readonly("board_size_x", &Environment::board_size_x)
         .def_readonly("board_size_y", &Environment::board_size_y)
-        .def_readonly("board", &Environment::board)
-        .def_readonly("current_player", &Environment::current_player)
+        .def_property_readonly("board",
+                               [](Environment &environment) {
+                                   std::vector<std::vector<Cell>> board(environment.board_size_x);
+                                   for (int i = 0; i < environment.board_size_x; i++) {
+                                       for (int j = 0; j < environment.board_size_y; j++) {
+                                           board[i].push_back(environment.cell(i, j));
+                                       }
+                                   }
+                                   return board;
+                               })
+        .def_property_readonly("current_player", &Environment::get_current_player)
         .def_readonly("variables", &Environment::variables)
+        .def_readonly("hash", &Environment::hash)
         .def("get_environment_representation", &Environment::get_environment_representation)
+        .def("get_side_effect_name",
+             [](Environment &environment, int side_effect) {
+                 return environment.definition->side_effects.at(side_effect)->get_name();
+             })
         .def("generate_moves", py::overload_cast<>(&Environment::generate_moves), py::return_value_policy::move)
         .def("getPlayerMoves", py::overload_cast<>(&Environment::generate_moves), py::return_value_policy::move)
-        .def("execute_move", &Environment::execute_move, py::arg("move") = std::vector<Step>(),
+        .def("execute_move", &Environment::execute_move, py::arg("move") = Move(),
              py::arg("searching") = false)
-        .def("playMove", &Environment::execute_move, py::arg("move") = std::vector<Step>(),
+        .def("playMove", &Environment::execute_move, py::arg("move") = Move(),
              py::arg("searching") = false)
         .def("undo_move", &Environment::undo_move, py::arg("searching") = false)
         .def("check_terminal_conditions", &Environment::check_terminal_conditions)
@@ -45,12 +68,24 @@ PYBIND11_MODULE(python_bindings, m) {
         .def_readonly("white_score", &Variables::white_score)
         .def_readonly("game_over", &Variables::game_over);
 
-    py::class_<Cell>(m, "Cell").def_readonly("piece", &Cell::piece).def_readonly("owners", &Cell::owners);
+    py::class_<Cell>(m, "Cell")
+        .def_property_readonly("piece", [](const Cell &cell) { return Symbols::get_piece_name(cell.piece); })
+        .def_property_readonly("owners", [](const Cell &cell) {
+            std::vector<std::string> owners;
+            for (int player = 0; player < Symbols::max_players; player++) {
+                if (cell.owners & (1u << player))
+                    owners.push_back(Symbols::get_player_name(player));
+            }
+            return owners;
+        });
 
-    py::class_<Step>(m, "Step")
-        .def_readonly("x", &Step::x)
-        .def_readonly("y", &Step::y)
-        .def_readonly("side_effect", &Step::side_effect);
+    py::class_<Step>(m, "Step").def_readonly("cell", &Step::cell).def_readonly("side_effect", &Step::side_effect);
 
-    py::class_<SideEffect, std::shared_ptr<SideEffect>>(m, "SideEffect").def("get_name", &SideEffect::get_name);
+    py::class_<Move>(m, "Move")
+        .def("__len__", &Move::size)
+        .def("__getitem__", [](const Move &move, int i) {
+            if (i < 0 || i >= move.size())
+                throw py::index_error();
+            return move[i];
+        });
 }
@@ -12,9 +12,41 @@
 
 #include "environment.hpp"
 #include "variables.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
 #include <string>
 
+/// @brief The IDs of the predicates in Predicates::get_predicate.
+/// @details
+///  Predicates::evaluate dispatches on these IDs with a switch instead of a
+///  virtual call, so the compiler can inline each predicate at its case.
+enum class PredicateId : uint8_t {
+    True,
+    Empty,
+    Opponent,
+    WhitePawn,
+    WhiteKnight,
+    WhiteBishop,
+    WhiteRook,
+    WhiteQueen,
+    WhiteKing,
+    BlackPawn,
+    BlackKnight,
+    BlackBishop,
+    BlackRook,
+    BlackQueen,
+    BlackKing,
+    PawnInitialRow,
+    FinalRow,
+    NotFinalRow,
+    EnPassantable,
+    RightToCastleLeft,
+    RightToCastleRight,
+    NotAttacked,
+};
+
 /// @brief Class to represent user-defined predicates for moves in abstract
 ///  board games.
 /// @author Bjarni Dagur Thor Kárason
@@ -26,7 +58,10 @@ class Predicate
     /// @brief Evaluates the predicate at the position (x, y) in an environment.
     /// @details
     ///  The (x, y) position corresponds to cell in the environment's board,
-    ///  environment->board[x][y].
+    ///  environment->cell(x, y).
+    ///
+    ///  Predicates keep their body in a static evaluate function with the same
+    ///  parameters, which Predicates::evaluate calls without constructing them.
     ///
     /// @pre The position (x, y) is within the environment's bounds.
     ///
@@ -37,10 +72,26 @@ class Predicate
     /// @param y the y coordinate to evaluate the predicate at.
     /// @return true if the predicate holds at (x, y).
     /// @return false if the predicate does not hold at (x, y).
-    virtual bool operator()(Environment *environment, int x, int y) = 0;
+    virtual bool operator()(Environment *environment, int x, int y) const = 0;
     /// @brief Returns the name of the predicate. Useful for debugging.
     /// @return the name of the predicate as std::string.
     virtual std::string get_name() const = 0;
+    /// @brief Returns the predicate's ID.
+    ///
+    /// @see Predicates::evaluate
+    int get_id() const {
+        return static_cast<int>(id);
+    }
+
+  protected:
+    /// @brief Predicate constructor.
+    ///
+    /// @param id the predicate's ID.
+    explicit Predicate(PredicateId id) : id(id) {}
+
+  private:
+    /// @brief The predicate's ID.
+    PredicateId id;
 };
 
 /// @brief A predicate that is always true.
@@ -52,7 +103,8 @@ class True : public Predicate
   public:
     True();
     ~True();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -63,7 +115,8 @@ class Empty : public Predicate
   public:
     Empty();
     ~Empty();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -74,7 +127,8 @@ class Opponent : public Predicate
   public:
     Opponent();
     ~Opponent();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -85,7 +139,8 @@ class WhitePawn : public Predicate
   public:
     WhitePawn();
     ~WhitePawn();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -96,7 +151,8 @@ class WhiteKnight : public Predicate
   public:
     WhiteKnight();
     ~WhiteKnight();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -107,7 +163,8 @@ class WhiteBishop : public Predicate
   public:
     WhiteBishop();
     ~WhiteBishop();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -118,7 +175,8 @@ class WhiteRook : public Predicate
   public:
     WhiteRook();
     ~WhiteRook();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -129,7 +187,8 @@ class WhiteQueen : public Predicate
   public:
     WhiteQueen();
     ~WhiteQueen();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -140,7 +199,8 @@ class WhiteKing : public Predicate
   public:
     WhiteKing();
     ~WhiteKing();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -151,7 +211,8 @@ class BlackPawn : public Predicate
   public:
     BlackPawn();
     ~BlackPawn();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -162,7 +223,8 @@ class BlackKnight : public Predicate
   public:
     BlackKnight();
     ~BlackKnight();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -173,7 +235,8 @@ class BlackBishop : public Predicate
   public:
     BlackBishop();
     ~BlackBishop();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -184,7 +247,8 @@ class BlackRook : public Predicate
   public:
     BlackRook();
     ~BlackRook();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -195,7 +259,8 @@ class BlackQueen : public Predicate
   public:
     BlackQueen();
     ~BlackQueen();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -206,7 +271,8 @@ class BlackKing : public Predicate
   public:
     BlackKing();
     ~BlackKing();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -217,7 +283,8 @@ class PawnInitialRow : public Predicate
   public:
     PawnInitialRow();
     ~PawnInitialRow();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -228,7 +295,8 @@ class FinalRow : public Predicate
   public:
     FinalRow();
     ~FinalRow();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -239,7 +307,8 @@ class NotFinalRow : public Predicate
   public:
     NotFinalRow();
     ~NotFinalRow();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -250,7 +319,8 @@ class EnPassantable : public Predicate
   public:
     EnPassantable();
     ~EnPassantable();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -261,7 +331,8 @@ class RightToCastleLeft : public Predicate
   public:
     RightToCastleLeft();
     ~RightToCastleLeft();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -272,7 +343,8 @@ class RightToCastleRight : public Predicate
   public:
     RightToCastleRight();
     ~RightToCastleRight();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 };
 
@@ -283,16 +355,17 @@ class NotAttacked : public Predicate
   public:
     NotAttacked();
     ~NotAttacked();
-    bool operator()(Environment *environment, int x, int y) override;
+    static bool evaluate(Environment *environment, int x, int y);
+    bool operator()(Environment *environment, int x, int y) const override;
     std::string get_name() const override;
 
   private:
-    bool attacked_by_pawn(Environment *environment, int x, int y);
-    bool attacked_by_knight(Environment *environment, int x, int y);
-    bool attacked_diagonally(Environment *environment, int x, int y);
-    bool attacked_straight(Environment *environment, int x, int y);
-    bool attacked_coef(Environment *environment, int x, int y, int x_coef, int y_coef,
-                       const std::vector<std::string> &opponents);
+    static bool attacked_by_pawn(Environment *environment, int x, int y);
+    static bool attacked_by_knight(Environment *environment, int x, int y);
+    static bool attacked_diagonally(Environment *environment, int x, int y);
+    static bool attacked_straight(Environment *environment, int x, int y);
+    static bool attacked_coef(Environment *environment, int x, int y, int x_coef, int y_coef,
+                              const std::array<int, 2> &opponents);
 };
 
 /// @brief Class to store all predicates to use in game descriptions.
@@ -304,5 +377,64 @@ class Predicates
     /// @details
     ///  When predicates are referenced in game descriptions they will be
     ///  fetched from this map.
-    static std::map<std::string, std::shared_ptr<Predicate>> get_predicate;
+    ///
+    ///  Predicates keep no mutable state, so the map is immutable and can be
+    ///  shared by any number of Environment instances and threads.
+    static const std::map<std::string, std::shared_ptr<const Predicate>> get_predicate;
+    /// @brief Evaluates the predicate with ID \p id at the position (x, y) in an environment.
+    /// @details
+    ///  Equivalent to calling Predicate::operator() of the predicate, but
+    ///  dispatches with a switch on \p id instead of a virtual call.
+    ///
+    /// @see PredicateId
+    static bool evaluate(int id, Environment *environment, int x, int y);
+
+  private:
+    /// @brief Evaluates the predicates that are not defined in this header.
+    ///
+    /// @see Predicates::evaluate
+    static bool evaluate_out_of_line(int id, Environment *environment, int x, int y);
 };
+
+// The simplest predicates are defined here so Predicates::evaluate can inline them.
+
+inline True::True() : Predicate(PredicateId::True) {}
+inline True::~True() {}
+inline bool True::evaluate(Environment *environment, int x, int y) {
+    return true;
+}
+inline bool True::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
+
+inline Empty::Empty() : Predicate(PredicateId::Empty) {}
+inline Empty::~Empty() {}
+inline bool Empty::evaluate(Environment *environment, int x, int y) {
+    return environment->cell(x, y).owners == 0;
+}
+inline bool Empty::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
+
+inline Opponent::Opponent() : Predicate(PredicateId::Opponent) {}
+inline Opponent::~Opponent() {}
+inline bool Opponent::evaluate(Environment *environment, int x, int y) {
+    unsigned int owners = environment->cell(x, y).owners;
+    return owners != 0 && !(owners & (1u << environment->current_player));
+}
+inline bool Opponent::operator()(Environment *environment, int x, int y) const {
+    return evaluate(environment, x, y);
+}
+
+inline bool Predicates::evaluate(int id, Environment *environment, int x, int y) {
+    switch (static_cast<PredicateId>(id)) {
+    case PredicateId::True:
+        return True::evaluate(environment, x, y);
+    case PredicateId::Empty:
+        return Empty::evaluate(environment, x, y);
+    case PredicateId::Opponent:
+        return Opponent::evaluate(environment, x, y);
+    default:
+        return evaluate_out_of_line(id, environment, x, y);
+    }
+}
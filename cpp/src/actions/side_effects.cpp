@@ -4,262 +4,253 @@
  */
 #include "side_effects.hpp"
 
-Default::Default() {}
+static const int white = Symbols::get_player_id("white");
+
+static const int empty = Symbols::get_piece_id("empty");
+static const int wPawn = Symbols::get_piece_id("wPawn");
+static const int wKnight = Symbols::get_piece_id("wKnight");
+static const int wBishop = Symbols::get_piece_id("wBishop");
+static const int wRook = Symbols::get_piece_id("wRook");
+static const int wQueen = Symbols::get_piece_id("wQueen");
+static const int wKing = Symbols::get_piece_id("wKing");
+static const int bPawn = Symbols::get_piece_id("bPawn");
+static const int bKnight = Symbols::get_piece_id("bKnight");
+static const int bBishop = Symbols::get_piece_id("bBishop");
+static const int bRook = Symbols::get_piece_id("bRook");
+static const int bQueen = Symbols::get_piece_id("bQueen");
+static const int bKing = Symbols::get_piece_id("bKing");
+
+// Indices of the Zobrist keys of the hashed variables, see Environment::variable_key.
+static const int black_king_moved_key = 0;
+static const int black_rook_left_moved_key = 1;
+static const int black_rook_right_moved_key = 2;
+static const int white_king_moved_key = 3;
+static const int white_rook_left_moved_key = 4;
+static const int white_rook_right_moved_key = 5;
+// Followed by one key per cell for the pawn that can be captured en passant.
+static const int en_passant_key = 6;
+// Variables::stagnation is not hashed. Like the halfmove clock in chess
+// engines' keys, hashing it would tell apart positions reached by moving pawns
+// in a different order. It only decides the game once 50 moves pass without a
+// pawn move or capture, so a transposition table can only merge states that
+// should differ in searches that reach that limit.
+
+// Sets the pawn that can be captured en passant and updates the hash.
+static void set_en_passant_pawn(Environment *environment, const std::tuple<int, int, int> &en_passant_pawn) {
+    int x, y;
+    std::tie(std::ignore, x, y) = environment->variables.en_passant_pawn;
+    if (x != -1)
+        environment->hash ^= environment->variable_key(en_passant_key + environment->square(x, y));
+    environment->set_variable(environment->variables.en_passant_pawn, en_passant_pawn);
+    std::tie(std::ignore, x, y) = en_passant_pawn;
+    if (x != -1)
+        environment->hash ^= environment->variable_key(en_passant_key + environment->square(x, y));
+}
+
+// Marks a king or rook as moved and updates the hash.
+static void mark_moved(Environment *environment, bool &moved, int key) {
+    if (moved)
+        return;
+    environment->hash ^= environment->variable_key(key);
+    environment->set_variable(moved, true);
+}
+
+Default::Default() : SideEffect(SideEffectId::Default) {}
 Default::~Default() {}
-void Default::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &old_cell = environment->board[old_x][old_y];
-    Cell &new_cell = environment->board[new_x][new_y];
-    cell_stack.push({old_cell, old_x, old_y});
-    cell_stack.push({new_cell, new_x, new_y});
-    stagnation_stack.push(environment->variables.stagnation);
+void Default::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Cell &old_cell = environment->cell(old_x, old_y);
+    Cell &new_cell = environment->cell(new_x, new_y);
+    // The pawn can only be captured en passant in the move right after it
+    // moved, so clear it once that move starts. EnPassantable already ignores
+    // older pawns, but clearing them keeps their key out of the hash, so
+    // positions that only differ in a stale en-passant pawn hash the same.
+    if (std::get<0>(environment->variables.en_passant_pawn) + 1 == environment->move_count)
+        set_en_passant_pawn(environment, {-2, -1, -1});
 
     if (old_x == new_x && old_y == new_y)
         return;
 
-    if (old_cell.piece == "bPawn" || old_cell.piece == "wPawn" || !new_cell.owners.empty())
-        environment->variables.stagnation = environment->move_count;
+    if (old_cell.piece == bPawn || old_cell.piece == wPawn || new_cell.owners != 0)
+        environment->set_variable(environment->variables.stagnation, environment->move_count);
 
-    new_cell.piece = old_cell.piece;
-    new_cell.owners = old_cell.owners;
-    new_cell.state = old_cell.state;
-    old_cell.piece = "empty";
-    old_cell.owners = std::vector<std::string>();
-    old_cell.state = nullptr;
+    environment->set_piece(new_x, new_y, old_cell.piece);
+    environment->set_piece(old_x, old_y, empty);
 }
-void Default::operator()(Environment *environment) {
-    int x, y;
-    for (int i = 0; i < 2; i++) {
-        x = std::get<1>(cell_stack.top());
-        y = std::get<2>(cell_stack.top());
-        environment->board[x][y] = std::get<0>(cell_stack.top());
-        cell_stack.pop();
-    }
-    environment->variables.stagnation = stagnation_stack.top();
-    stagnation_stack.pop();
+void Default::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string Default::get_name() const {
     return "Default";
 }
 
-PromoteToQueen::PromoteToQueen() {}
+PromoteToQueen::PromoteToQueen() : SideEffect(SideEffectId::PromoteToQueen) {}
 PromoteToQueen::~PromoteToQueen() {}
-void PromoteToQueen::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &cell = environment->board[new_x][new_y];
-    cell_stack.push({cell, new_x, new_y});
-    if (!cell.owners.empty() && cell.owners[0] == "white") {
-        cell.piece = "wQueen";
-        cell.state = environment->pieces["wQueen"].second.get();
-    }
-    else {
-        cell.piece = "bQueen";
-        cell.state = environment->pieces["bQueen"].second.get();
-    }
+void PromoteToQueen::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Cell &cell = environment->cell(new_x, new_y);
+    if (cell.owners & (1u << white))
+        environment->set_piece(new_x, new_y, wQueen);
+    else
+        environment->set_piece(new_x, new_y, bQueen);
 }
-void PromoteToQueen::operator()(Environment *environment) {
-    int x = std::get<1>(cell_stack.top());
-    int y = std::get<2>(cell_stack.top());
-    environment->board[x][y] = std::get<0>(cell_stack.top());
-    cell_stack.pop();
+void PromoteToQueen::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string PromoteToQueen::get_name() const {
     return "PromoteToQueen";
 }
 
-PromoteToRook::PromoteToRook() {}
+PromoteToRook::PromoteToRook() : SideEffect(SideEffectId::PromoteToRook) {}
 PromoteToRook::~PromoteToRook() {}
-void PromoteToRook::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &cell = environment->board[new_x][new_y];
-    cell_stack.push({cell, new_x, new_y});
-    if (!cell.owners.empty() && cell.owners[0] == "white") {
-        cell.piece = "wRook";
-        cell.state = environment->pieces["wRook"].second.get();
-    }
-    else {
-        cell.piece = "bRook";
-        cell.state = environment->pieces["bRook"].second.get();
-    }
+void PromoteToRook::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Cell &cell = environment->cell(new_x, new_y);
+    if (cell.owners & (1u << white))
+        environment->set_piece(new_x, new_y, wRook);
+    else
+        environment->set_piece(new_x, new_y, bRook);
 }
-void PromoteToRook::operator()(Environment *environment) {
-    int x = std::get<1>(cell_stack.top());
-    int y = std::get<2>(cell_stack.top());
-    environment->board[x][y] = std::get<0>(cell_stack.top());
-    cell_stack.pop();
+void PromoteToRook::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string PromoteToRook::get_name() const {
     return "PromoteToRook";
 }
 
-PromoteToBishop::PromoteToBishop() {}
+PromoteToBishop::PromoteToBishop() : SideEffect(SideEffectId::PromoteToBishop) {}
 PromoteToBishop::~PromoteToBishop() {}
-void PromoteToBishop::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &cell = environment->board[new_x][new_y];
-    cell_stack.push({cell, new_x, new_y});
-    if (!cell.owners.empty() && cell.owners[0] == "white") {
-        cell.piece = "wBishop";
-        cell.state = environment->pieces["wBishop"].second.get();
-    }
-    else {
-        cell.piece = "bBishop";
-        cell.state = environment->pieces["bBishop"].second.get();
-    }
+void PromoteToBishop::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Cell &cell = environment->cell(new_x, new_y);
+    if (cell.owners & (1u << white))
+        environment->set_piece(new_x, new_y, wBishop);
+    else
+        environment->set_piece(new_x, new_y, bBishop);
 }
-void PromoteToBishop::operator()(Environment *environment) {
-    int x = std::get<1>(cell_stack.top());
-    int y = std::get<2>(cell_stack.top());
-    environment->board[x][y] = std::get<0>(cell_stack.top());
-    cell_stack.pop();
+void PromoteToBishop::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string PromoteToBishop::get_name() const {
     return "PromoteToBishop";
 }
 
-PromoteToKnight::PromoteToKnight() {}
+PromoteToKnight::PromoteToKnight() : SideEffect(SideEffectId::PromoteToKnight) {}
 PromoteToKnight::~PromoteToKnight() {}
-void PromoteToKnight::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &cell = environment->board[new_x][new_y];
-    cell_stack.push({cell, new_x, new_y});
-    if (!cell.owners.empty() && cell.owners[0] == "white") {
-        cell.piece = "wKnight";
-        cell.state = environment->pieces["wKnight"].second.get();
-    }
-    else {
-        cell.piece = "bKnight";
-        cell.state = environment->pieces["bKnight"].second.get();
-    }
+void PromoteToKnight::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Cell &cell = environment->cell(new_x, new_y);
+    if (cell.owners & (1u << white))
+        environment->set_piece(new_x, new_y, wKnight);
+    else
+        environment->set_piece(new_x, new_y, bKnight);
 }
-void PromoteToKnight::operator()(Environment *environment) {
-    int x = std::get<1>(cell_stack.top());
-    int y = std::get<2>(cell_stack.top());
-    environment->board[x][y] = std::get<0>(cell_stack.top());
-    cell_stack.pop();
+void PromoteToKnight::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string PromoteToKnight::get_name() const {
     return "PromoteToKnight";
 }
 
-SetEnPassantable::SetEnPassantable() {}
+SetEnPassantable::SetEnPassantable() : SideEffect(SideEffectId::SetEnPassantable) {}
 SetEnPassantable::~SetEnPassantable() {}
-void SetEnPassantable::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    en_passant_stack.push(environment->variables.en_passant_pawn);
-    environment->variables.en_passant_pawn = {environment->move_count, new_x, new_y};
+void SetEnPassantable::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    set_en_passant_pawn(environment, {environment->move_count, new_x, new_y});
 }
-void SetEnPassantable::operator()(Environment *environment) {
-    environment->variables.en_passant_pawn = en_passant_stack.top();
-    en_passant_stack.pop();
+void SetEnPassantable::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string SetEnPassantable::get_name() const {
     return "SetEnPassantable";
 }
 
-CastleLeft::CastleLeft() {}
+CastleLeft::CastleLeft() : SideEffect(SideEffectId::CastleLeft) {}
 CastleLeft::~CastleLeft() {}
-void CastleLeft::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &rook_src = environment->board[new_x][new_y - 2];
-    Cell &rook_dst = environment->board[new_x][new_y + 1];
-    cell_stack.push({rook_src, new_x, new_y - 2});
-    cell_stack.push({rook_dst, new_x, new_y + 1});
-
-    rook_dst.piece = rook_src.piece;
-    rook_dst.owners = rook_src.owners;
-    rook_dst.state = rook_src.state;
-    rook_src.piece = "empty";
-    rook_src.owners = std::vector<std::string>();
-    rook_src.state = nullptr;
+void CastleLeft::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Cell &rook_src = environment->cell(new_x, new_y - 2);
+    environment->set_piece(new_x, new_y + 1, rook_src.piece);
+    environment->set_piece(new_x, new_y - 2, empty);
 }
-void CastleLeft::operator()(Environment *environment) {
-    int x, y;
-    for (int i = 0; i < 2; i++) {
-        x = std::get<1>(cell_stack.top());
-        y = std::get<2>(cell_stack.top());
-        environment->board[x][y] = std::get<0>(cell_stack.top());
-        cell_stack.pop();
-    }
+void CastleLeft::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string CastleLeft::get_name() const {
     return "CastleLeft";
 }
 
-CastleRight::CastleRight() {}
+CastleRight::CastleRight() : SideEffect(SideEffectId::CastleRight) {}
 CastleRight::~CastleRight() {}
-void CastleRight::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    Cell &rook_src = environment->board[new_x][new_y + 1];
-    Cell &rook_dst = environment->board[new_x][new_y - 1];
-    cell_stack.push({rook_src, new_x, new_y + 1});
-    cell_stack.push({rook_dst, new_x, new_y - 1});
-
-    rook_dst.piece = rook_src.piece;
-    rook_dst.owners = rook_src.owners;
-    rook_dst.state = rook_src.state;
-    rook_src.piece = "empty";
-    rook_src.owners = std::vector<std::string>();
-    rook_src.state = nullptr;
+void CastleRight::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Cell &rook_src = environment->cell(new_x, new_y + 1);
+    environment->set_piece(new_x, new_y - 1, rook_src.piece);
+    environment->set_piece(new_x, new_y + 1, empty);
 }
-void CastleRight::operator()(Environment *environment) {
-    int x, y;
-    for (int i = 0; i < 2; i++) {
-        x = std::get<1>(cell_stack.top());
-        y = std::get<2>(cell_stack.top());
-        environment->board[x][y] = std::get<0>(cell_stack.top());
-        cell_stack.pop();
-    }
+void CastleRight::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string CastleRight::get_name() const {
     return "CastleRight";
 }
 
-MarkMoved::MarkMoved() {}
+MarkMoved::MarkMoved() : SideEffect(SideEffectId::MarkMoved) {}
 MarkMoved::~MarkMoved() {}
-void MarkMoved::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
-    bool *var_ptr = nullptr, val;
-    if (environment->board[new_x][new_y].piece == "bKing") {
-        var_ptr = &environment->variables.black_king_moved;
-        val = environment->variables.black_king_moved;
-        environment->variables.black_king_moved = true;
+void MarkMoved::execute(Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    Variables &variables = environment->variables;
+    int piece = environment->cell(new_x, new_y).piece;
+    if (piece == bKing) {
+        mark_moved(environment, variables.black_king_moved, black_king_moved_key);
     }
-    else if (environment->board[new_x][new_y].piece == "wKing") {
-        var_ptr = &environment->variables.white_king_moved;
-        val = environment->variables.white_king_moved;
-        environment->variables.white_king_moved = true;
+    else if (piece == wKing) {
+        mark_moved(environment, variables.white_king_moved, white_king_moved_key);
     }
-    else if (environment->board[new_x][new_y].piece == "bRook") {
-        if (environment->board[0][0].piece != "bRook") {
-            var_ptr = &environment->variables.black_rook_left_moved;
-            val = environment->variables.black_rook_left_moved;
-            environment->variables.black_rook_left_moved = true;
-        }
-        if (environment->board[0][7].piece != "bRook") {
-            var_ptr = &environment->variables.black_rook_right_moved;
-            val = environment->variables.black_rook_right_moved;
-            environment->variables.black_rook_right_moved = true;
-        }
+    else if (piece == bRook) {
+        if (environment->cell(0, 0).piece != bRook)
+            mark_moved(environment, variables.black_rook_left_moved, black_rook_left_moved_key);
+        if (environment->cell(0, 7).piece != bRook)
+            mark_moved(environment, variables.black_rook_right_moved, black_rook_right_moved_key);
     }
-    else if (environment->board[new_x][new_y].piece == "wRook") {
-        if (environment->board[7][0].piece != "wRook") {
-            var_ptr = &environment->variables.white_rook_left_moved;
-            val = environment->variables.white_rook_left_moved;
-            environment->variables.white_rook_left_moved = true;
-        }
-        if (environment->board[7][7].piece != "wRook") {
-            var_ptr = &environment->variables.white_rook_right_moved;
-            val = environment->variables.white_rook_right_moved;
-            environment->variables.white_rook_right_moved = true;
-        }
+    else if (piece == wRook) {
+        if (environment->cell(7, 0).piece != wRook)
+            mark_moved(environment, variables.white_rook_left_moved, white_rook_left_moved_key);
+        if (environment->cell(7, 7).piece != wRook)
+            mark_moved(environment, variables.white_rook_right_moved, white_rook_right_moved_key);
     }
-    moved_stack.push({var_ptr, val});
 }
-void MarkMoved::operator()(Environment *environment) {
-    bool *var_ptr, val;
-    std::tie(var_ptr, val) = moved_stack.top();
-    moved_stack.pop();
-    if (var_ptr) {
-        *var_ptr = val;
-    }
+void MarkMoved::operator()(Environment *environment, int old_x, int old_y, int new_x, int new_y) const {
+    execute(environment, old_x, old_y, new_x, new_y);
 }
 std::string MarkMoved::get_name() const {
     return "MarkMoved";
 }
 
-std::map<std::string, std::shared_ptr<SideEffect>> SideEffects::get_side_effect = {
+void SideEffects::execute(int id, Environment *environment, int old_x, int old_y, int new_x, int new_y) {
+    switch (static_cast<SideEffectId>(id)) {
+    case SideEffectId::Default:
+        Default::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    case SideEffectId::PromoteToQueen:
+        PromoteToQueen::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    case SideEffectId::PromoteToRook:
+        PromoteToRook::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    case SideEffectId::PromoteToBishop:
+        PromoteToBishop::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    case SideEffectId::PromoteToKnight:
+        PromoteToKnight::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    case SideEffectId::SetEnPassantable:
+        SetEnPassantable::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    case SideEffectId::CastleLeft:
+        CastleLeft::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    case SideEffectId::CastleRight:
+        CastleRight::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    case SideEffectId::MarkMoved:
+        MarkMoved::execute(environment, old_x, old_y, new_x, new_y);
+        break;
+    }
+}
+
+const std::map<std::string, std::shared_ptr<const SideEffect>> SideEffects::get_side_effect = {
     {"Default", std::make_shared<Default>()},
     {"PromoteToQueen", std::make_shared<PromoteToQueen>()},
     {"PromoteToRook", std::make_shared<PromoteToRook>()},
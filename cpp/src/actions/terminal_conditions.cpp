@@ -4,25 +4,35 @@
  */
 #include "terminal_conditions.hpp"
 
+static const int black = Symbols::get_player_id("black");
+
+static const int wKing = Symbols::get_piece_id("wKing");
+static const int bKing = Symbols::get_piece_id("bKing");
+
 NoMovesLeft::NoMovesLeft() {}
 NoMovesLeft::~NoMovesLeft() {}
-bool NoMovesLeft::operator()(Environment *environment) {
+bool NoMovesLeft::operator()(Environment *environment) const {
     if (environment->variables.n_moves_found != 0)
         return false;
 
-    std::string own_king = environment->current_player == "black" ? "bKing" : "wKing";
-    bool check_mate = false, done = false;
-    for (size_t i = 0; !done && i < environment->board.size(); i++) {
-        for (size_t j = 0; !done && j < environment->board[0].size(); j++) {
-            if (environment->board[i][j].piece == own_king) {
-                check_mate = !(*(Predicates::get_predicate["NotAttacked"]))(environment, i, j);
-                done = true;
-            }
-        }
+    int own_king = environment->current_player == black ? bKing : wKing;
+    bool check_mate = false;
+    int square = -1;
+    if (environment->has_bitboards) {
+        Bitboard king = environment->piece_bitboards[own_king];
+        if (king != 0)
+            square = Environment::pop_square(king);
+    }
+    else if (!environment->piece_squares[own_king].empty()) {
+        square = environment->piece_squares[own_king][0];
+    }
+    if (square != -1) {
+        int x = square / environment->board_size_y, y = square % environment->board_size_y;
+        check_mate = !Predicates::evaluate(static_cast<int>(PredicateId::NotAttacked), environment, x, y);
     }
 
     if (check_mate) {
-        if (environment->current_player == "black") {
+        if (environment->current_player == black) {
             environment->variables.black_score = -1;
             environment->variables.white_score = 1;
         }
@@ -44,7 +54,7 @@ std::string NoMovesLeft::get_name() const {
 
 Stagnation::Stagnation() {}
 Stagnation::~Stagnation() {}
-bool Stagnation::operator()(Environment *environment) {
+bool Stagnation::operator()(Environment *environment) const {
     if (environment->move_count - environment->variables.stagnation >= 50) {
         environment->variables.black_score = 0;
         environment->variables.white_score = 0;
@@ -57,7 +67,7 @@ std::string Stagnation::get_name() const {
     return "Stagnation";
 }
 
-std::map<std::string, std::shared_ptr<TerminalCondition>> TerminalConditions::terminal_conditions = {
+const std::map<std::string, std::shared_ptr<const TerminalCondition>> TerminalConditions::terminal_conditions = {
     {"NoMovesLeft", std::make_shared<NoMovesLeft>()},
     {"Stagnation", std::make_shared<Stagnation>()},
 };
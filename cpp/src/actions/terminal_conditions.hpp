@@ -36,7 +36,7 @@ class TerminalCondition
     /// @param environment pointer to an environment to evaluate the terminal condition in.
     /// @return true if the terminal condition holds.
     /// @return false if the terminal condition does not holds.
-    virtual bool operator()(Environment *environment) = 0;
+    virtual bool operator()(Environment *environment) const = 0;
     /// @brief Returns the name of the predicate. Useful for debugging.
     /// @return the name of the predicate as std::string.
     virtual std::string get_name() const = 0;
@@ -49,7 +49,7 @@ class NoMovesLeft : public TerminalCondition
   public:
     NoMovesLeft();
     ~NoMovesLeft();
-    bool operator()(Environment *environment) override;
+    bool operator()(Environment *environment) const override;
     std::string get_name() const override;
 };
 
@@ -60,7 +60,7 @@ class Stagnation : public TerminalCondition
   public:
     Stagnation();
     ~Stagnation();
-    bool operator()(Environment *environment) override;
+    bool operator()(Environment *environment) const override;
     std::string get_name() const override;
 };
 
@@ -73,5 +73,8 @@ class TerminalConditions
     /// @details
     ///  When terminal conditions are checked they will be fetched from this
     ///  map.
-    static std::map<std::string, std::shared_ptr<TerminalCondition>> terminal_conditions;
+    ///
+    ///  Terminal conditions keep no mutable state, so the map is immutable and can be
+    ///  shared by any number of Environment instances and threads.
+    static const std::map<std::string, std::shared_ptr<const TerminalCondition>> terminal_conditions;
 };
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+/**
+ *  @file allocation_counter.hpp
+ *  @brief Counts heap allocations in the benchmarking tools.
+ *  @details
+ *   Replaces the global operator new and operator delete, so it must be
+ *   included in exactly one translation unit of an executable, and only in
+ *   benchmarking tools.
+ *  @author Bjarni Dagur Thor Kárason
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/// @brief Counts heap allocations made through operator new.
+///
+/// @author Bjarni Dagur Thor Kárason
+namespace AllocationCounter {
+/// @brief The number of heap allocations made so far.
+inline std::atomic<long long> n_allocations{0};
+/// @brief Returns the number of heap allocations made so far.
+inline long long get_count() {
+    return n_allocations.load(std::memory_order_relaxed);
+}
+} // namespace AllocationCounter
+
+void *operator new(std::size_t size) {
+    AllocationCounter::n_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
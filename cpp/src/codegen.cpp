@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+/**
+ *  @file codegen.cpp
+ *  @brief A tool that compiles the DFAs of a game description to C++.
+ *  @author Bjarni Dagur Thor Kárason
+ */
+#include "parser.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <queue>
+#include <string>
+#include <vector>
+
+/// @brief What is known about a DFA state on an empty board.
+struct StateInfo {
+    /// @brief True if a piece can be in this state.
+    bool reachable = false;
+    /// @brief For each edge leaving the state, true if it lands on the board
+    ///  from some position the state can be reached at.
+    std::vector<bool> edge_on_board;
+    /// @brief For each edge leaving the state, true if it leaves the board
+    ///  from some position the state can be reached at.
+    std::vector<bool> edge_off_board;
+};
+
+/// @brief Finds where DFA states can be reached on an empty board.
+/// @details
+///  Starts each of the DFAs on every Cell and follows all transitions that
+///  stay on the board, ignoring predicates.
+///
+/// @param definition the game the DFAs belong to.
+/// @param initial_states the initial states of the DFAs in GameDefinition#transitions.
+std::vector<StateInfo> analyze(const GameDefinition &definition, const std::vector<int> &initial_states) {
+    const DFATable &transitions = definition.transitions;
+    int board_size_x = definition.board_size_x, board_size_y = definition.board_size_y;
+    std::vector<StateInfo> info(transitions.size());
+    for (int state = 0; state < transitions.size(); state++) {
+        int n_edges = transitions.end(state) - transitions.begin(state);
+        info[state].edge_on_board.assign(n_edges, false);
+        info[state].edge_off_board.assign(n_edges, false);
+    }
+    std::vector<bool> visited(transitions.size() * board_size_x * board_size_y, false);
+    std::queue<int> q;
+    auto visit = [&](int state, int x, int y) {
+        int index = (state * board_size_x + x) * board_size_y + y;
+        if (!visited[index]) {
+            visited[index] = true;
+            q.push(index);
+        }
+    };
+    for (int state : initial_states) {
+        for (int x = 0; x < board_size_x; x++) {
+            for (int y = 0; y < board_size_y; y++) {
+                visit(state, x, y);
+            }
+        }
+    }
+    while (!q.empty()) {
+        int index = q.front();
+        q.pop();
+        int state = index / (board_size_x * board_size_y);
+        int x = index / board_size_y % board_size_x, y = index % board_size_y;
+        info[state].reachable = true;
+        for (const DFAEdge *edge = transitions.begin(state); edge != transitions.end(state); edge++) {
+            int i = edge - transitions.begin(state);
+            int next_x = x - edge->dy, next_y = y + edge->dx;
+            if (next_x < 0 || next_x >= board_size_x || next_y < 0 || next_y >= board_size_y) {
+                info[state].edge_off_board[i] = true;
+                continue;
+            }
+            info[state].edge_on_board[i] = true;
+            visit(edge->target, next_x, next_y);
+        }
+    }
+    return info;
+}
+
+/// @brief Returns true if no edge of a state ever lands on the board, see DFATable::is_final.
+bool is_final(const StateInfo &info) {
+    return std::none_of(info.edge_on_board.begin(), info.edge_on_board.end(), [](bool on_board) { return on_board; });
+}
+
+/// @brief Returns \p offset as a signed term to add to an expression.
+std::string term(int offset) {
+    if (offset == 0)
+        return "";
+    return offset > 0 ? " + " + std::to_string(offset) : " - " + std::to_string(-offset);
+}
+
+/// @brief Returns a comment describing \p edge as a letter of the game description.
+std::string describe(const GameDefinition &definition, const std::vector<std::string> &predicate_names,
+                     const DFAEdge &edge) {
+    return "[" + std::to_string(edge.dx) + ", " + std::to_string(edge.dy) + ", " + predicate_names[edge.predicate] +
+           "] {" + definition.side_effects[edge.side_effect]->get_name() + "}";
+}
+
+/// @brief Returns the condition for taking \p edge from (x, y).
+///
+/// @param definition the game the edge belongs to.
+/// @param edge the edge.
+/// @param check_border true to check the sentinel border, for edges that can leave the board.
+/// @param indent the indentation of the condition's first line.
+std::string condition(const GameDefinition &definition, const DFAEdge &edge, bool check_border,
+                      const std::string &indent) {
+    std::ostringstream oss;
+    if (check_border) {
+        int stride = definition.board_size_y + 2 * definition.border;
+        oss << "environment->board[(x" << term(definition.border - edge.dy) << ") * " << stride << " + y"
+            << term(definition.border + edge.dx) << "].piece != Cell::off_board &&\n"
+            << indent << "    ";
+    }
+    oss << "Predicates::evaluate(" << int(edge.predicate) << ", environment, x" << term(-edge.dy) << ", y"
+        << term(edge.dx) << ")";
+    return oss.str();
+}
+
+/// @brief Writes C++ code that runs the transitions of DFAs.
+/// @details
+///  Writes one function per reachable state, named \p prefix followed by the
+///  state, and a function named \p prefix that dispatches on the state.
+///  The offsets, the predicate and side effect IDs and the board dimensions
+///  are constants. Transitions that can never land on the board are left
+///  out, and the sentinel check is left out of transitions that can never
+///  leave it. A state's ray (see DFATable::ray) is followed in a loop, and
+///  steps that complete a move go through Environment::accept_final_step.
+///
+/// @param definition the game the DFAs belong to.
+/// @param info what is known about each state, see analyze.
+/// @param prefix the name of the functions.
+/// @param post_condition true to check post conditions, false to generate moves.
+/// @param out the stream to write the code to.
+void generate_dfas(const GameDefinition &definition, const std::vector<StateInfo> &info, const std::string &prefix,
+                   bool post_condition, std::ostream &out) {
+    const DFATable &transitions = definition.transitions;
+    std::vector<std::string> predicate_names(Predicates::get_predicate.size());
+    for (const auto &p : Predicates::get_predicate) {
+        predicate_names.at(p.second->get_id()) = p.first;
+    }
+    std::string return_type = post_condition ? "bool " : "void ";
+
+    for (int state = 0; state < transitions.size(); state++) {
+        if (info[state].reachable)
+            out << return_type << prefix << "_" << state << "(Environment *environment, int x, int y);\n";
+    }
+    for (int state = 0; state < transitions.size(); state++) {
+        if (!info[state].reachable)
+            continue;
+        out << "\n" << return_type << prefix << "_" << state << "(Environment *environment, int x, int y) {\n";
+        if (post_condition && transitions.is_accepting(state)) {
+            out << "    return false;\n";
+            out << "}\n";
+            continue;
+        }
+        // Follow the state's ray in a loop, see DFATable::ray.
+        const DFAEdge *ray = transitions.ray(state);
+        int ray_index = ray != nullptr ? ray - transitions.begin(state) : -1;
+        if (ray != nullptr && !info[state].edge_on_board[ray_index])
+            ray = nullptr;
+        std::string indent = ray != nullptr ? "        " : "    ";
+        if (ray != nullptr) {
+            if (!post_condition)
+                out << "    int n_ray_steps = 0;\n";
+            out << "    while (true) {\n";
+        }
+        if (transitions.is_accepting(state))
+            out << indent << "environment->accept_candidate_move();\n";
+        for (const DFAEdge *edge = transitions.begin(state); edge != transitions.end(state); edge++) {
+            int i = edge - transitions.begin(state);
+            if (edge == ray || !info[state].edge_on_board[i])
+                continue;
+            // Edges to states that can neither accept nor continue do nothing.
+            if (!post_condition && is_final(info[edge->target]) && !transitions.is_accepting(edge->target))
+                continue;
+            out << indent << "// " << describe(definition, predicate_names, *edge) << "\n";
+            out << indent << "if (" << condition(definition, *edge, info[state].edge_off_board[i], indent);
+            if (post_condition) {
+                out << " &&\n"
+                    << indent << "    !" << prefix << "_" << edge->target << "(environment, x" << term(-edge->dy)
+                    << ", y" << term(edge->dx) << "))\n";
+                out << indent << "    return false;\n";
+                continue;
+            }
+            out << ") {\n";
+            if (is_final(info[edge->target])) {
+                out << indent << "    environment->accept_final_step(x, y, x" << term(-edge->dy) << ", y"
+                    << term(edge->dx) << ", " << int(edge->side_effect) << ");\n";
+                out << indent << "}\n";
+                continue;
+            }
+            out << indent << "    environment->push_step(x, y, x" << term(-edge->dy) << ", y" << term(edge->dx) << ", "
+                << int(edge->side_effect) << ");\n";
+            out << indent << "    " << prefix << "_" << edge->target << "(environment, x" << term(-edge->dy) << ", y"
+                << term(edge->dx) << ");\n";
+            out << indent << "    environment->pop_step();\n";
+            out << indent << "}\n";
+        }
+        if (ray != nullptr) {
+            out << indent << "// " << describe(definition, predicate_names, *ray) << "*\n";
+            out << indent << "if (!(" << condition(definition, *ray, info[state].edge_off_board[ray_index], indent)
+                << "))\n";
+            out << indent << (post_condition ? "    return true;\n" : "    break;\n");
+            if (!post_condition) {
+                out << indent << "environment->push_step(x, y, x" << term(-ray->dy) << ", y" << term(ray->dx)
+                    << ", " << int(ray->side_effect) << ");\n";
+                out << indent << "n_ray_steps++;\n";
+            }
+            if (ray->dy != 0)
+                out << indent << "x" << (ray->dy > 0 ? " -= " : " += ") << std::abs(ray->dy) << ";\n";
+            if (ray->dx != 0)
+                out << indent << "y" << (ray->dx > 0 ? " += " : " -= ") << std::abs(ray->dx) << ";\n";
+            out << "    }\n";
+            if (!post_condition) {
+                out << "    for (; n_ray_steps > 0; n_ray_steps--) {\n";
+                out << "        environment->pop_step();\n";
+                out << "    }\n";
+            }
+        }
+        else if (post_condition) {
+            out << "    return true;\n";
+        }
+        out << "}\n";
+    }
+    out << "\n" << return_type << prefix << "(Environment *environment, int state, int x, int y) {\n";
+    out << "    switch (state) {\n";
+    for (int state = 0; state < transitions.size(); state++) {
+        if (!info[state].reachable)
+            continue;
+        out << "    case " << state << ":\n";
+        if (post_condition) {
+            out << "        return " << prefix << "_" << state << "(environment, x, y);\n";
+            continue;
+        }
+        out << "        " << prefix << "_" << state << "(environment, x, y);\n";
+        out << "        break;\n";
+    }
+    out << "    }\n";
+    if (post_condition)
+        out << "    return true;\n";
+    out << "}\n";
+}
+
+/// @brief Writes C++ code that generates the moves and checks the post
+///  conditions of a game.
+/// @details
+///  The code registers itself with GameDefinition::register_compiled_dfas,
+///  so an executable it is linked into uses it for this game description
+///  only.
+void generate(const GameDefinition &definition, const std::string &game_path, std::ostream &out) {
+    std::vector<int> post_condition_states;
+    for (const auto &player_post_conditions : definition.post_condition_states) {
+        for (const auto &post_condition : player_post_conditions) {
+            post_condition_states.push_back(post_condition.second);
+        }
+    }
+
+    out << "// Generated by codegen-abstract-board-games from " << game_path << ". Do not edit.\n";
+    out << "#include \"environment.hpp\"\n";
+    out << "#include \"predicates.hpp\"\n";
+    out << "#include \"side_effects.hpp\"\n\n";
+    out << "namespace {\n\n";
+    generate_dfas(definition, analyze(definition, definition.piece_states), "generate_moves", false, out);
+    out << "\n";
+    generate_dfas(definition, analyze(definition, post_condition_states), "verify_post_condition", true, out);
+    out << "\nconst bool registered = GameDefinition::register_compiled_dfas(" << definition.fingerprint()
+        << "ULL, generate_moves, verify_post_condition);\n\n";
+    out << "} // namespace\n";
+}
+
+/// @brief Takes an Abstract Boardgame description and writes a C++ source
+///  file with its DFAs compiled to code.
+/// @details
+///  Linking the source file into an executable along with the predicates and
+///  side effects of the game makes it generate moves and check post
+///  conditions without interpreting the DFAs, see
+///  GameDefinition#move_generator and GameDefinition#post_condition_checker.
+/// @author Bjarni Dagur Thor Kárason
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <gamefile> <outputfile>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Parser parser(argv[1]);
+    parser.parse();
+    std::shared_ptr<const GameDefinition> definition = parser.get_game_definition();
+
+    std::ofstream output_file(argv[2]);
+    if (!output_file.is_open()) {
+        std::cerr << "Failed to open file " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+    generate(*definition, argv[1], output_file);
+
+    return EXIT_SUCCESS;
+}
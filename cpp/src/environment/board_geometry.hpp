@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+/**
+ *  @file board_geometry.hpp
+ *  @brief Defines board geometries that Environment specializes its hot loops for.
+ *  @author Bjarni Dagur Thor Kárason
+ *  @see Environment
+ */
+#pragma once
+
+#include <cassert>
+
+/// @brief The geometry of a board whose size and border are known at compile time.
+/// @details
+///  Converts between coordinates, squares (see Environment::square) and
+///  indices into Environment#board. With the board size and border as
+///  constants the compiler can strength-reduce the multiplications, divisions
+///  and remainders these conversions need and fold the border into the
+///  offsets of Environment#board.
+///
+///  Environment instantiates its move generation and undo routines for the
+///  common board sizes, see Environment::select_geometry.
+///
+/// @tparam SizeX the board's size along the x axis.
+/// @tparam SizeY the board's size along the y axis.
+/// @tparam Border the width of the sentinel border around the board.
+///
+/// @author Bjarni Dagur Thor Kárason
+template <int SizeX, int SizeY, int Border> class BoardGeometry
+{
+  public:
+    static_assert(SizeX > 0 && SizeY > 0 && Border >= 0, "board geometries need a positive size");
+    /// @brief The distance between rows in Environment#board.
+    static constexpr int stride = SizeY + 2 * Border;
+    /// @brief BoardGeometry constructor.
+    ///
+    /// @param size_x the board's size along the x axis, which must be \p SizeX.
+    /// @param size_y the board's size along the y axis, which must be \p SizeY.
+    /// @param border the width of the sentinel border around the board, which must be \p Border.
+    BoardGeometry(int size_x, int size_y, int border) {
+        assert(size_x == SizeX && size_y == SizeY && border == Border);
+    }
+    /// @brief Returns the square of (\p x, \p y).
+    int square(int x, int y) const {
+        return x * SizeY + y;
+    }
+    /// @brief Returns the x coordinate of \p square.
+    int x(int square) const {
+        return square / SizeY;
+    }
+    /// @brief Returns the y coordinate of \p square.
+    int y(int square) const {
+        return square % SizeY;
+    }
+    /// @brief Returns the index of (\p x, \p y) in Environment#board.
+    int cell_index(int x, int y) const {
+        return (x + Border) * stride + y + Border;
+    }
+};
+
+/// @brief The geometry of a board whose size is only known at run time.
+/// @details
+///  Used for boards that Environment has no specialization for.
+///
+/// @author Bjarni Dagur Thor Kárason
+template <> class BoardGeometry<0, 0, 0>
+{
+  public:
+    /// @brief BoardGeometry constructor.
+    ///
+    /// @param size_x the board's size along the x axis.
+    /// @param size_y the board's size along the y axis.
+    /// @param border the width of the sentinel border around the board.
+    BoardGeometry(int size_x, int size_y, int border)
+        : size_y(size_y), border(border), stride(size_y + 2 * border) {}
+    /// @brief Returns the square of (\p x, \p y).
+    int square(int x, int y) const {
+        return x * size_y + y;
+    }
+    /// @brief Returns the x coordinate of \p square.
+    int x(int square) const {
+        return square / size_y;
+    }
+    /// @brief Returns the y coordinate of \p square.
+    int y(int square) const {
+        return square % size_y;
+    }
+    /// @brief Returns the index of (\p x, \p y) in Environment#board.
+    int cell_index(int x, int y) const {
+        return (x + border) * stride + y + border;
+    }
+
+  private:
+    /// @brief The board's size along the y axis.
+    int size_y;
+    /// @brief The width of the sentinel border around the board.
+    int border;
+    /// @brief The distance between rows in Environment#board.
+    int stride;
+};
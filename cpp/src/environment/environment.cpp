@@ -17,32 +17,159 @@
 #define COUTRED "\033[1m\033[31m"
 #define COUTBLUE "\033[1m\033[34m"
 
-Cell::Cell() {}
-Cell::Cell(std::string piece, std::vector<std::string> owners, DFAState *state)
+Cell::Cell() : piece(off_board), owners(~0u), state(0) {}
+Cell::Cell(int piece, unsigned int owners, int state)
     : piece(piece), owners(owners), state(state) {}
 Cell::~Cell() {}
 
-Step::Step(int x, int y, std::shared_ptr<SideEffect> side_effect) : x(x), y(y), side_effect(side_effect) {}
-Step::~Step() {}
+Step::Step(int cell, int side_effect) : cell(cell), side_effect(side_effect) {}
 
-Environment::Environment(int board_size_x, int board_size_y)
-    : board_size_x(board_size_x), board_size_y(board_size_y), move_count(0), variables(Variables()) {}
+Environment::Environment(std::shared_ptr<const GameDefinition> definition)
+    : definition(definition), board_size_x(definition->board_size_x), board_size_y(definition->board_size_y),
+      move_count(0), border(definition->border), stride(board_size_y + 2 * border),
+      has_bitboards(board_size_x * board_size_y <= 64), occupied(0), current_player(definition->players[0]),
+      variables(Variables()), hash(0), geometry_routines(select_geometry(board_size_x, board_size_y, border)),
+      move_sink(nullptr), move_sink_context(nullptr), n_found_moves(0), check_post_conditions(true),
+      apply_final_steps(true) {
+    if (definition->max_move_length > Move::max_steps) {
+        std::ostringstream oss;
+        oss << "Moves of this game can be " << definition->max_move_length << " steps long but at most "
+            << Move::max_steps << " steps are supported.";
+        std::string error_msg = oss.str();
+        throw std::runtime_error(error_msg);
+    }
+    set_board();
+    journal.reserve(1024);
+}
 Environment::~Environment() {}
 
+const Environment::GeometryRoutines *Environment::select_geometry(int board_size_x, int board_size_y, int border) {
+#define GEOMETRY_ROUTINES(...)                                                                                        \
+    {&Environment::generate_all_moves<__VA_ARGS__>, &Environment::verify_post_conditions<__VA_ARGS__>,                \
+     &Environment::execute_steps<__VA_ARGS__>, &Environment::rewind_journal<__VA_ARGS__>}
+    static const GeometryRoutines board_3x3 = GEOMETRY_ROUTINES(BoardGeometry<3, 3, 1>);
+    static const GeometryRoutines board_4x4 = GEOMETRY_ROUTINES(BoardGeometry<4, 4, 1>);
+    static const GeometryRoutines board_6x7 = GEOMETRY_ROUTINES(BoardGeometry<6, 7, 1>);
+    static const GeometryRoutines board_7x6 = GEOMETRY_ROUTINES(BoardGeometry<7, 6, 1>);
+    static const GeometryRoutines board_8x8 = GEOMETRY_ROUTINES(BoardGeometry<8, 8, 1>);
+    static const GeometryRoutines board_8x8_border_2 = GEOMETRY_ROUTINES(BoardGeometry<8, 8, 2>);
+    static const GeometryRoutines any_board = GEOMETRY_ROUTINES(BoardGeometry<0, 0, 0>);
+#undef GEOMETRY_ROUTINES
+    if (border == 1) {
+        if (board_size_x == 3 && board_size_y == 3)
+            return &board_3x3;
+        if (board_size_x == 4 && board_size_y == 4)
+            return &board_4x4;
+        if (board_size_x == 6 && board_size_y == 7)
+            return &board_6x7;
+        if (board_size_x == 7 && board_size_y == 6)
+            return &board_7x6;
+        if (board_size_x == 8 && board_size_y == 8)
+            return &board_8x8;
+    }
+    // Chess needs a border of 2 for the knights' jumps.
+    if (border == 2 && board_size_x == 8 && board_size_y == 8)
+        return &board_8x8_border_2;
+    return &any_board;
+}
+
 bool Environment::contains_cell(size_t x, size_t y) {
-    return 0 <= x && x < board.size() && 0 <= y && y < board[0].size();
+    return x < (size_t)board_size_x && y < (size_t)board_size_y;
+}
+
+Bitboard Environment::row_bitboard(int x) const {
+    Bitboard row = board_size_y == 64 ? ~Bitboard(0) : (Bitboard(1) << board_size_y) - 1;
+    return row << (x * board_size_y);
+}
+
+void Environment::set_board() {
+    board.assign((board_size_x + 2 * border) * stride, Cell());
+    int n_cells = board_size_x * board_size_y;
+    hash = definition->player_keys[current_player];
+    if (has_bitboards) {
+        piece_bitboards.assign(definition->pieces.size(), 0);
+        player_bitboards.assign(Symbols::max_players, 0);
+        occupied = 0;
+    }
+    else {
+        piece_squares.assign(definition->pieces.size(), SquareSet(n_cells));
+        player_squares.assign(Symbols::max_players, SquareSet(n_cells));
+    }
+    for (int i = 0; i < board_size_x; i++) {
+        for (int j = 0; j < board_size_y; j++) {
+            int piece = definition->initial_board[square(i, j)];
+            cell(i, j) = Cell(piece, definition->pieces[piece].first, definition->piece_states[piece]);
+            hash ^= definition->piece_keys[piece * n_cells + square(i, j)];
+            if (has_bitboards) {
+                Cell &c = cell(i, j);
+                Bitboard bit = Bitboard(1) << square(i, j);
+                piece_bitboards[c.piece] |= bit;
+                for (unsigned int owners = c.owners; owners != 0; owners &= owners - 1) {
+                    player_bitboards[__builtin_ctz(owners)] |= bit;
+                }
+                if (c.owners != 0)
+                    occupied |= bit;
+            }
+            else {
+                Cell &c = cell(i, j);
+                piece_squares[c.piece].insert(square(i, j));
+                for (unsigned int owners = c.owners; owners != 0; owners &= owners - 1) {
+                    player_squares[__builtin_ctz(owners)].insert(square(i, j));
+                }
+            }
+        }
+    }
+}
+
+void Environment::set_piece(int x, int y, int piece) {
+    journal.push_back({JournalEntry::CellChange, 0, square(x, y), static_cast<uint64_t>(cell(x, y).piece)});
+    place_piece(x, y, piece);
+}
+
+void Environment::place_piece(int x, int y, int piece) {
+    Cell &c = cell(x, y);
+    int n_cells = board_size_x * board_size_y;
+    const std::vector<uint64_t> &piece_keys = definition->piece_keys;
+    hash ^= piece_keys[c.piece * n_cells + square(x, y)] ^ piece_keys[piece * n_cells + square(x, y)];
+    if (has_bitboards) {
+        Bitboard bit = Bitboard(1) << square(x, y);
+        unsigned int new_owners = definition->pieces[piece].first;
+        piece_bitboards[c.piece] &= ~bit;
+        piece_bitboards[piece] |= bit;
+        for (unsigned int changed = c.owners ^ new_owners; changed != 0; changed &= changed - 1) {
+            player_bitboards[__builtin_ctz(changed)] ^= bit;
+        }
+        if (new_owners != 0)
+            occupied |= bit;
+        else
+            occupied &= ~bit;
+    }
+    else if (c.piece != piece) {
+        unsigned int new_owners = definition->pieces[piece].first;
+        piece_squares[c.piece].erase(square(x, y));
+        piece_squares[piece].insert(square(x, y));
+        for (unsigned int changed = c.owners ^ new_owners; changed != 0; changed &= changed - 1) {
+            int player = __builtin_ctz(changed);
+            if (new_owners & (1u << player))
+                player_squares[player].insert(square(x, y));
+            else
+                player_squares[player].erase(square(x, y));
+        }
+    }
+    c.piece = piece;
+    c.owners = definition->pieces[piece].first;
+    c.state = definition->piece_states[piece];
 }
 
 std::vector<std::vector<std::vector<int>>> Environment::get_environment_representation() {
     std::vector<std::vector<std::vector<int>>> representation;
 
     // One plane indicating presence of each piece type.
-    for (auto &p : pieces) {
-        std::string piece_name = p.first;
-        std::vector<std::vector<int>> piece_bitmap(board.size(), std::vector<int>(board[0].size(), 0));
-        for (size_t i = 0; i < board.size(); i++) {
-            for (size_t j = 0; j < board[0].size(); j++) {
-                if (board[i][j].piece == piece_name) {
+    for (int piece : definition->declared_pieces) {
+        std::vector<std::vector<int>> piece_bitmap(board_size_x, std::vector<int>(board_size_y, 0));
+        for (int i = 0; i < board_size_x; i++) {
+            for (int j = 0; j < board_size_y; j++) {
+                if (cell(i, j).piece == piece) {
                     piece_bitmap[i][j] = 1;
                 }
             }
@@ -51,99 +178,233 @@ std::vector<std::vector<std::vector<int>>> Environment::get_environment_represen
     }
 
     // One plane indicating whose turn it is. Assumes two players.
-    std::vector<std::vector<int>> turn(board.size(), std::vector<int>(board[0].size(), current_player == players[0]));
+    bool first_player = current_player == definition->players[0];
+    std::vector<std::vector<int>> turn(board_size_x, std::vector<int>(board_size_y, first_player));
     representation.push_back(turn);
 
     return representation;
 }
 
-std::vector<std::vector<Step>> Environment::generate_moves() {
-    found_moves.clear();
-    for (size_t i = 0; i < board.size(); i++) {
-        for (size_t j = 0; j < board[0].size(); j++) {
-            const std::vector<std::string> &owners = board[i][j].owners;
-            if (std::find(owners.begin(), owners.end(), current_player) != owners.end()) {
-                candidate_move.clear();
-                candidate_move.push_back(Step(i, j, SideEffects::get_side_effect["Default"]));
-                generate_moves(board[i][j].state, i, j);
-            }
+std::vector<Move> Environment::generate_moves() {
+    std::vector<Move> moves;
+    generate_moves(moves);
+    return moves;
+}
+
+void Environment::generate_moves(std::vector<Move> &moves) {
+    moves.clear();
+    visit_moves([&moves](const Move &move) { moves.push_back(move); });
+}
+
+int Environment::count_moves() {
+    return generate_moves([](void *, const Move &) {}, nullptr, false);
+}
+
+void Environment::generate_pseudo_legal_moves(std::vector<Move> &moves) {
+    moves.clear();
+    visit_pseudo_legal_moves([&moves](const Move &move) { moves.push_back(move); });
+}
+
+int Environment::generate_moves(MoveSink sink, void *context, bool pseudo_legal) {
+    move_sink = sink;
+    move_sink_context = context;
+    n_found_moves = 0;
+    check_post_conditions = !pseudo_legal;
+    // Which cells post conditions read is not tracked, so any post condition
+    // of the player makes every final step execute.
+    apply_final_steps = check_post_conditions && !definition->post_condition_states[current_player].empty();
+    (this->*geometry_routines->generate_all_moves)();
+
+    variables.n_moves_found = n_found_moves;
+
+    if (n_found_moves == 0)
+        check_terminal_conditions();
+
+    return n_found_moves;
+}
+
+bool Environment::is_legal(const Move &move) {
+    execute_move(move, true);
+    bool legal = verify_post_conditions();
+    undo_move(true);
+    return legal;
+}
+
+int Environment::legalize(std::vector<Move> &moves) {
+    moves.erase(std::remove_if(moves.begin(), moves.end(), [this](const Move &move) { return !is_legal(move); }),
+                moves.end());
+    variables.n_moves_found = moves.size();
+    if (moves.empty())
+        check_terminal_conditions();
+    return moves.size();
+}
+
+void Environment::throw_move_list_full(int capacity) {
+    std::ostringstream oss;
+    oss << "More than " << capacity << " legal moves do not fit in the move list.";
+    std::string error_msg = oss.str();
+    throw std::runtime_error(error_msg);
+}
+
+template <typename Geometry> void Environment::generate_all_moves() {
+    Geometry geometry(board_size_x, board_size_y, border);
+    if (has_bitboards) {
+        for (Bitboard own = player_bitboards[current_player]; own != 0;) {
+            generate_piece_moves(geometry, pop_square(own));
         }
+        return;
     }
+    const SquareSet &own = player_squares[current_player];
+    origin_squares.assign(own.begin(), own.end());
+    for (int square : origin_squares) {
+        generate_piece_moves(geometry, square);
+    }
+}
 
-    variables.n_moves_found = found_moves.size();
+template <typename Geometry> void Environment::generate_piece_moves(const Geometry &geometry, int square) {
+    int x = geometry.x(square), y = geometry.y(square);
+    int state = board[geometry.cell_index(x, y)].state;
+    candidate_move.clear();
+    candidate_move.push_back(Step(square, definition->default_side_effect));
+    if (definition->move_generator != nullptr)
+        definition->move_generator(this, state, x, y);
+    else
+        generate_moves(geometry, state, square);
+}
 
-    if (found_moves.empty())
-        check_terminal_conditions();
+template <typename Geometry> void Environment::generate_moves(const Geometry &geometry, int state, int square) {
+    const DFATable &transitions = definition->transitions;
+    const DFAEdge *ray = transitions.ray(state);
+    int n_ray_steps = 0;
+    while (true) {
+        if (transitions.is_accepting(state))
+            accept_candidate_move();
+        int x = geometry.x(square), y = geometry.y(square);
+        for (const SquareEdge *edge = transitions.begin(state, square); edge != transitions.end(state, square);
+             edge++) {
+            int next_x = geometry.x(edge->next_square);
+            int next_y = geometry.y(edge->next_square);
+            if (!Predicates::evaluate(edge->predicate, this, next_x, next_y))
+                continue;
+            if (transitions.is_final(edge->target, edge->next_square)) {
+                if (transitions.is_accepting(edge->target))
+                    accept_final_step(x, y, next_x, next_y, edge->side_effect);
+                continue;
+            }
+            push_step(x, y, next_x, next_y, edge->side_effect);
+            generate_moves(geometry, edge->target, edge->next_square);
+            pop_step();
+        }
+        // Follow the ray in a loop instead of recursing for every cell along it.
+        if (ray == nullptr)
+            break;
+        int next_square = transitions.offset_target(square, transitions.ray_offset(state));
+        if (next_square == DFATable::off_board)
+            break;
+        int next_x = geometry.x(next_square);
+        int next_y = geometry.y(next_square);
+        if (!Predicates::evaluate(ray->predicate, this, next_x, next_y))
+            break;
+        push_step(x, y, next_x, next_y, ray->side_effect);
+        n_ray_steps++;
+        square = next_square;
+    }
+    for (; n_ray_steps > 0; n_ray_steps--) {
+        pop_step();
+    }
+}
 
-    return std::move(found_moves);
+void Environment::accept_candidate_move() {
+    if (!check_post_conditions || verify_post_conditions()) {
+        n_found_moves++;
+        move_sink(move_sink_context, candidate_move);
+    }
 }
 
-void Environment::generate_moves(DFAState *state, int x, int y) {
-    if (state->is_accepting && verify_post_conditions())
-        found_moves.push_back(candidate_move);
-    for (auto &p : state->transition) {
-        const DFAInput &input = p.first;
-        int next_x = x - input.dy;
-        int next_y = y + input.dx;
-        if (!contains_cell(next_x, next_y))
-            continue;
-        if (!(*input.predicate)(this, next_x, next_y))
-            continue;
-        candidate_move.push_back(Step(next_x, next_y, input.side_effect));
-        execute_move(
-            std::vector<Step>{candidate_move[candidate_move.size() - 2], candidate_move[candidate_move.size() - 1]},
-            true);
-        generate_moves(p.second, next_x, next_y);
-        candidate_move.pop_back();
-        undo_move(true);
+void Environment::accept_final_step(int x, int y, int next_x, int next_y, int side_effect) {
+    if (apply_final_steps) {
+        push_step(x, y, next_x, next_y, side_effect);
+        accept_candidate_move();
+        pop_step();
+        return;
     }
+    candidate_move.push_back(Step(square(next_x, next_y), side_effect));
+    n_found_moves++;
+    move_sink(move_sink_context, candidate_move);
+    candidate_move.pop_back();
+}
+
+void Environment::push_step(int x, int y, int next_x, int next_y, int side_effect) {
+    candidate_move.push_back(Step(square(next_x, next_y), side_effect));
+    journal.push_back({JournalEntry::MoveStart, 0, variables.n_moves_found, hash});
+    SideEffects::execute(side_effect, this, x, y, next_x, next_y);
+}
+
+void Environment::pop_step() {
+    candidate_move.pop_back();
+    undo_move(true);
 }
 
 bool Environment::verify_post_conditions() {
-    for (auto &p : post_conditions[current_player]) {
-        const std::string &piece = p.first;
-        const std::unique_ptr<DFAState, DFAStateDeleter> &post_condition = p.second;
-        for (size_t i = 0; i < board.size(); i++) {
-            for (size_t j = 0; j < board[0].size(); j++) {
-                if (board[i][j].piece == piece) {
-                    if (!verify_post_condition(post_condition.get(), i, j)) {
-                        return false;
-                    }
+    return (this->*geometry_routines->verify_post_conditions)();
+}
+
+template <typename Geometry> bool Environment::verify_post_conditions() {
+    Geometry geometry(board_size_x, board_size_y, border);
+    PostConditionChecker checker = definition->post_condition_checker;
+    auto verify = [&](int state, int square) {
+        if (checker != nullptr)
+            return checker(this, state, geometry.x(square), geometry.y(square));
+        return verify_post_condition(geometry, state, square);
+    };
+    for (const auto &p : definition->post_condition_states[current_player]) {
+        int piece = p.first;
+        int post_condition = p.second;
+        if (has_bitboards) {
+            for (Bitboard cells = piece_bitboards[piece]; cells != 0;) {
+                if (!verify(post_condition, pop_square(cells))) {
+                    return false;
                 }
             }
+            continue;
+        }
+        for (int square : piece_squares[piece]) {
+            if (!verify(post_condition, square)) {
+                return false;
+            }
         }
     }
     return true;
 }
 
-bool Environment::verify_post_condition(DFAState *state, int x, int y) {
-    if (state->is_accepting)
+template <typename Geometry> bool Environment::verify_post_condition(const Geometry &geometry, int state, int square) {
+    const DFATable &transitions = definition->transitions;
+    if (transitions.is_accepting(state))
         return false;
-    bool res = true;
-    for (auto &p : state->transition) {
-        const DFAInput &input = p.first;
-        int next_x = x - input.dy;
-        int next_y = y + input.dx;
-        if (!contains_cell(next_x, next_y))
-            continue;
-        if (!(*input.predicate)(this, next_x, next_y))
-            continue;
-        res &= verify_post_condition(p.second, next_x, next_y);
+    const DFAEdge *ray = transitions.ray(state);
+    while (true) {
+        for (const SquareEdge *edge = transitions.begin(state, square); edge != transitions.end(state, square);
+             edge++) {
+            if (!Predicates::evaluate(edge->predicate, this, geometry.x(edge->next_square),
+                                      geometry.y(edge->next_square)))
+                continue;
+            if (!verify_post_condition(geometry, edge->target, edge->next_square))
+                return false;
+        }
+        if (ray == nullptr)
+            return true;
+        int next_square = transitions.offset_target(square, transitions.ray_offset(state));
+        if (next_square == DFATable::off_board)
+            return true;
+        if (!Predicates::evaluate(ray->predicate, this, geometry.x(next_square), geometry.y(next_square)))
+            return true;
+        square = next_square;
     }
-    return res;
 }
 
-void Environment::execute_move(const std::vector<Step> &move, bool searching) {
-    int n_steps = move.size();
-    for (int i = 1; i < n_steps; i++) {
-        int old_x = move[i - 1].x;
-        int old_y = move[i - 1].y;
-        int new_x = move[i].x;
-        int new_y = move[i].y;
-        (*(move[i].side_effect))(this, old_x, old_y, new_x, new_y);
-        side_effect_stack.push(move[i].side_effect);
-    }
-    counter_stack.push({n_steps - 1, variables.n_moves_found});
+void Environment::execute_move(const Move &move, bool searching) {
+    journal.push_back({JournalEntry::MoveStart, 0, variables.n_moves_found, hash});
+    (this->*geometry_routines->execute_steps)(move);
     if (!searching) {
         move_count++;
         check_terminal_conditions();
@@ -151,41 +412,82 @@ void Environment::execute_move(const std::vector<Step> &move, bool searching) {
     }
 }
 
-void Environment::undo_move(bool searching) {
-    int n_side_effects;
-    std::tie(n_side_effects, variables.n_moves_found) = counter_stack.top();
-    counter_stack.pop();
-    for (int i = 0; i < n_side_effects; i++) {
-        (*(side_effect_stack.top()))(this);
-        side_effect_stack.pop();
+template <typename Geometry> void Environment::execute_steps(const Move &move) {
+    Geometry geometry(board_size_x, board_size_y, border);
+    int n_steps = move.size();
+    for (int i = 1; i < n_steps; i++) {
+        int old_x = geometry.x(move[i - 1].cell);
+        int old_y = geometry.y(move[i - 1].cell);
+        int new_x = geometry.x(move[i].cell);
+        int new_y = geometry.y(move[i].cell);
+        SideEffects::execute(move[i].side_effect, this, old_x, old_y, new_x, new_y);
     }
+}
+
+void Environment::undo_move(bool searching) {
+    (this->*geometry_routines->rewind_journal)();
+    variables.n_moves_found = journal.back().index;
+    uint64_t previous_hash = journal.back().value;
+    journal.pop_back();
     if (!searching) {
         move_count--;
         update_current_player();
         variables.game_over = false;
     }
+    hash = previous_hash;
+}
+
+template <typename Geometry> void Environment::rewind_journal() {
+    Geometry geometry(board_size_x, board_size_y, border);
+    char *variable_bytes = reinterpret_cast<char *>(&variables);
+    while (journal.back().kind != JournalEntry::MoveStart) {
+        const JournalEntry &entry = journal.back();
+        if (entry.kind == JournalEntry::CellChange)
+            place_piece(geometry.x(entry.index), geometry.y(entry.index), static_cast<int>(entry.value));
+        else
+            std::memcpy(variable_bytes + entry.index, &entry.value, entry.size);
+        journal.pop_back();
+    }
+}
+
+void Environment::journal_variable(const void *variable, size_t size) {
+    const char *bytes = static_cast<const char *>(variable);
+    int offset = bytes - reinterpret_cast<const char *>(&variables);
+    for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+        JournalEntry entry = {JournalEntry::VariableChange, 0, offset + static_cast<int>(i), 0};
+        entry.size = std::min(size - i, sizeof(uint64_t));
+        std::memcpy(&entry.value, bytes + i, entry.size);
+        journal.push_back(entry);
+    }
 }
 
 bool Environment::check_terminal_conditions() {
     bool game_over = false;
     for (auto &p : TerminalConditions::terminal_conditions) {
-        const std::shared_ptr<TerminalCondition> &terminal_condition = p.second;
+        const std::shared_ptr<const TerminalCondition> &terminal_condition = p.second;
         if ((*terminal_condition)(this))
             game_over = true;
     }
     return game_over;
 }
 
+uint64_t Environment::variable_key(int index) const {
+    return definition->variable_key(index);
+}
+
 void Environment::update_current_player() {
-    current_player = players[move_count % players.size()];
+    const std::vector<int> &players = definition->players;
+    int next_player = players[move_count % players.size()];
+    hash ^= definition->player_keys[current_player] ^ definition->player_keys[next_player];
+    current_player = next_player;
 }
 
 std::string Environment::get_first_player() {
-    return players[0];
+    return Symbols::get_player_name(definition->players[0]);
 }
 
 std::string Environment::get_current_player() {
-    return current_player;
+    return Symbols::get_player_name(current_player);
 }
 
 bool Environment::game_over() {
@@ -197,25 +499,31 @@ int Environment::get_white_score() {
 }
 
 void Environment::reset() {
-    while (!counter_stack.empty()) {
+    while (!journal.empty()) {
         undo_move();
     }
     variables = Variables();
 }
 
 void Environment::print() {
-    for (size_t i = 0; i < board.size(); i++) {
+    // Games without white or black players are printed without colors.
+    int white_id = Symbols::find_player_id("white");
+    int black_id = Symbols::find_player_id("black");
+    unsigned int white = white_id >= 0 ? 1u << white_id : ~0u;
+    unsigned int black = black_id >= 0 ? 1u << black_id : ~0u;
+    for (int i = 0; i < board_size_x; i++) {
         if (i != 0)
             std::cout << "\n";
-        for (size_t j = 0; j < board[0].size(); j++) {
+        for (int j = 0; j < board_size_y; j++) {
             if (j != 0)
                 std::cout << " ";
-            if (board[i][j].owners.size() == 1 && board[i][j].owners[0] == "white")
-                std::cout << COUTBLUE << std::setw(8) << board[i][j].piece << COUTRESET;
-            else if (board[i][j].owners.size() == 1 && board[i][j].owners[0] == "black")
-                std::cout << COUTRED << std::setw(8) << board[i][j].piece << COUTRESET;
+            const std::string &piece_name = Symbols::get_piece_name(cell(i, j).piece);
+            if (cell(i, j).owners == white)
+                std::cout << COUTBLUE << std::setw(8) << piece_name << COUTRESET;
+            else if (cell(i, j).owners == black)
+                std::cout << COUTRED << std::setw(8) << piece_name << COUTRESET;
             else
-                std::cout << std::setw(8) << board[i][j].piece;
+                std::cout << std::setw(8) << piece_name;
         }
         std::cout << "\n";
     }
@@ -224,35 +532,36 @@ void Environment::print() {
 
 std::string Environment::jsonify() {
     std::string json = "{\"board\": [";
-    for (size_t i = 0; i < board[0].size(); i++) {
+    for (int i = 0; i < board_size_y; i++) {
         if (i != 0)
             json += ", ";
         json += "[";
-        for (size_t j = 0; j < board.size(); j++) {
+        for (int j = 0; j < board_size_x; j++) {
             if (j != 0)
                 json += ", ";
-            json += "\"" + board[board.size() - 1 - j][i].piece + "\"";
+            json += "\"" + Symbols::get_piece_name(cell(board_size_x - 1 - j, i).piece) + "\"";
         }
         json += "]";
     }
     json += "], \"moves\": [";
-    std::vector<std::vector<Step>> moves = generate_moves();
+    std::vector<Move> moves = generate_moves();
     bool need_move_separator = false;
-    for (const std::vector<Step> &move : moves) {
+    for (const Move &move : moves) {
         if (need_move_separator)
             json += ", ";
         json += "{\"start\": [";
-        int x = move[0].x, y = move[0].y;
-        json += std::to_string(y) + ", " + std::to_string(board.size() - 1 - x);
+        int x = move[0].cell / board_size_y, y = move[0].cell % board_size_y;
+        json += std::to_string(y) + ", " + std::to_string(board_size_x - 1 - x);
         json += "], \"letters\": [";
         bool need_step_separator = false;
-        for (size_t i = 1; i < move.size(); i++) {
+        for (int i = 1; i < move.size(); i++) {
             if (need_step_separator)
                 json += ", ";
-            int dx = move[i].y - y, dy = -(move[i].x - x);
-            x = move[i].x, y = move[i].y;
+            int next_x = move[i].cell / board_size_y, next_y = move[i].cell % board_size_y;
+            int dx = next_y - y, dy = -(next_x - x);
+            x = next_x, y = next_y;
             json += "{\"dx\": " + std::to_string(dx) + ", \"dy\": " + std::to_string(dy) + ", \"effect\": \"" +
-                    move[i].side_effect->get_name() + "\"}";
+                    definition->side_effects[move[i].side_effect]->get_name() + "\"}";
             need_step_separator = true;
         }
         json += "]";
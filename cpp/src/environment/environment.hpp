@@ -9,38 +9,72 @@
  */
 #pragma once
 
+#include "board_geometry.hpp"
 #include "dfa.hpp"
+#include "game_definition.hpp"
+#include "square_set.hpp"
+#include "symbols.hpp"
 #include "variables.hpp"
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
-#include <stack>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#ifndef ABG_MAX_MOVE_STEPS
+#define ABG_MAX_MOVE_STEPS 16
+#endif
+
 /// @brief Class to represent a single cell in a game board.
+/// @details
+///  The cells surrounding the board (see Environment#board) are sentinel cells
+///  holding the Cell::off_board piece. Move generation recognizes them by
+///  their piece alone instead of checking the coordinates against the board's
+///  bounds. They are owned by every player, so ownership tests such as
+///  "empty" or "belongs to an opponent" also fail on them.
 /// @author Bjarni Dagur Thor Kárason
 class Cell
 {
   public:
+    /// @brief The piece ID of sentinel cells outside the board.
+    static constexpr int off_board = -1;
     /// @brief Cell constructor.
+    /// @details Constructs a sentinel cell outside the board.
     Cell();
     /// @brief Cell constructor from cell state information.
     ///
-    /// @param piece the name of the piece on this Cell.
-    /// @param owners the list of players who own the \p piece on this Cell.
-    /// @param state a DFA that generates legal moves for the \p piece on this Cell.
-    Cell(std::string piece, std::vector<std::string> owners, DFAState *state);
+    /// @param piece the ID of the piece on this Cell.
+    /// @param owners the set of players who own the \p piece on this Cell.
+    /// @param state the initial state in GameDefinition#transitions of a DFA
+    ///  that generates legal moves for the \p piece on this Cell.
+    Cell(int piece, unsigned int owners, int state);
     /// @brief Cell destructor.
     ~Cell();
-    /// @brief The name of the piece on this Cell.
-    std::string piece;
-    /// @brief The list of players who own the \p piece on this Cell.
-    std::vector<std::string> owners;
-    /// @brief A DFA that generates legal moves for the \p piece on this Cell.
-    DFAState *state;
+    /// @brief The ID of the piece on this Cell.
+    ///
+    /// @see Symbols
+    int piece;
+    /// @brief The set of players who own the \p piece on this Cell.
+    /// @details
+    ///  Player with ID \f$i\f$ owns the piece if bit \f$i\f$ is set.
+    ///
+    /// @see Symbols
+    unsigned int owners;
+    /// @brief The initial state in GameDefinition#transitions of a DFA that
+    ///  generates legal moves for the \p piece on this Cell.
+    int state;
 };
 
+/// @brief A set of cells on a board with at most 64 cells.
+/// @details
+///  Cell (x, y) corresponds to bit Environment::square(x, y).
+typedef uint64_t Bitboard;
+
 /// @brief Class to represent a single step in a piece's move.
 /// @details
 ///  A piece's move \f$s_0 s_1 \ldots s_n\f$ is composed of multiple Step where
@@ -53,76 +87,246 @@ class Cell
 class Step
 {
   public:
+    /// @brief Step constructor.
+    /// @details Leaves the step uninitialized so a Move is trivially copyable.
+    Step() = default;
     /// @brief Step constructor from move components.
     ///
-    /// @param x the x coordinate of the destination Cell as an array index.
-    /// @param y the y coordinate of the destination Cell as an array index.
-    /// @param side_effect the SideEffect of the move.
-    Step(int x, int y, std::shared_ptr<SideEffect> side_effect);
-    /// @brief Step destructor.
-    ~Step();
-    /// @brief The x coordinate of the destination Cell as an array index.
-    int x;
-    /// @brief The y coordinate of the destination Cell as an array index.
-    int y;
-    /// @brief The SideEffect of the move.
-    std::shared_ptr<SideEffect> side_effect;
+    /// @param cell the destination Cell as Environment::square.
+    /// @param side_effect the ID of the SideEffect of the move, see Environment#side_effects.
+    Step(int cell, int side_effect);
+    /// @brief The destination Cell as Environment::square.
+    uint16_t cell;
+    /// @brief The ID of the SideEffect of the move, see Environment#side_effects.
+    uint8_t side_effect;
+};
+
+/// @brief Class to represent a piece's move as a fixed-size sequence of Step.
+/// @details
+///  A Move is trivially copyable, so lists of moves can be copied with memcpy
+///  and copying a move neither allocates nor touches reference counts.
+///
+///  The parser computes the longest path through every piece's state machine
+///  and rejects game descriptions whose moves do not fit in Move::max_steps,
+///  including games where a piece can move around a cycle on the board forever.
+///  The limit defaults to 16 steps and can be raised at build time by defining
+///  ABG_MAX_MOVE_STEPS (the MAX_MOVE_STEPS CMake cache variable).
+///
+/// @see Step
+/// @see GameDefinition#max_move_length
+///
+/// @author Bjarni Dagur Thor Kárason
+class Move
+{
+  public:
+    /// @brief The maximum number of steps in a move, including the initial position.
+    static constexpr int max_steps = ABG_MAX_MOVE_STEPS;
+    static_assert(max_steps > 0 && max_steps <= 255, "ABG_MAX_MOVE_STEPS must fit in a uint8_t step count");
+    /// @brief Returns the number of steps in the move.
+    int size() const {
+        return n_steps;
+    }
+    /// @brief Returns true if the move has no steps.
+    bool empty() const {
+        return n_steps == 0;
+    }
+    /// @brief Returns the \p i-th step of the move.
+    const Step &operator[](int i) const {
+        return steps[i];
+    }
+    /// @brief Returns the last step of the move.
+    const Step &back() const {
+        return steps[n_steps - 1];
+    }
+    /// @brief Appends a step to the move.
+    ///
+    /// @pre The move has fewer than Move::max_steps steps.
+    void push_back(const Step &step) {
+        steps[n_steps++] = step;
+    }
+    /// @brief Removes the last step of the move.
+    void pop_back() {
+        n_steps--;
+    }
+    /// @brief Removes all steps of the move.
+    void clear() {
+        n_steps = 0;
+    }
+    /// @brief Returns an iterator to the first step.
+    const Step *begin() const {
+        return steps;
+    }
+    /// @brief Returns an iterator past the last step.
+    const Step *end() const {
+        return steps + n_steps;
+    }
+
+  private:
+    /// @brief The steps of the move.
+    Step steps[max_steps];
+    /// @brief The number of steps in the move.
+    uint8_t n_steps = 0;
+};
+
+/// @brief A list of at most \p N moves stored inline, e.g. on the stack.
+/// @details
+///  Lets search loops generate moves without touching the heap. Pass it to
+///  Environment::generate_moves, which throws if the position has more than
+///  \p N legal moves.
+///
+/// @tparam N the largest number of moves the list can hold.
+///
+/// @author Bjarni Dagur Thor Kárason
+template <int N> class MoveList
+{
+  public:
+    /// @brief The largest number of moves the list can hold.
+    static constexpr int capacity = N;
+    /// @brief Returns the number of moves in the list.
+    int size() const {
+        return n_moves;
+    }
+    /// @brief Returns true if the list has no moves.
+    bool empty() const {
+        return n_moves == 0;
+    }
+    /// @brief Returns the \p i-th move in the list.
+    const Move &operator[](int i) const {
+        return moves[i];
+    }
+    /// @brief Appends a move to the list.
+    ///
+    /// @pre The list has fewer than MoveList::capacity moves.
+    void push_back(const Move &move) {
+        moves[n_moves++] = move;
+    }
+    /// @brief Removes all moves from the list.
+    void clear() {
+        n_moves = 0;
+    }
+    /// @brief Returns an iterator to the first move.
+    const Move *begin() const {
+        return moves;
+    }
+    /// @brief Returns an iterator past the last move.
+    const Move *end() const {
+        return moves + n_moves;
+    }
+
+  private:
+    /// @brief The moves in the list.
+    Move moves[N];
+    /// @brief The number of moves in the list.
+    int n_moves = 0;
+};
+
+/// @brief A record in the undo journal of an Environment.
+/// @details
+///  Plain data, so the journal is one contiguous array that is rewound
+///  linearly when a move is undone. Each move starts with a
+///  JournalEntry::MoveStart entry, followed by one entry for every Cell or
+///  Variables member the move changed.
+///
+/// @see Environment::undo_move
+///
+/// @author Bjarni Dagur Thor Kárason
+struct JournalEntry {
+    /// @brief What the entry records.
+    enum Kind : uint8_t {
+        /// @brief The start of a move. JournalEntry#index is the previous
+        ///  Variables#n_moves_found, JournalEntry#value the previous Environment#hash.
+        MoveStart,
+        /// @brief A changed Cell. JournalEntry#index is its Environment::square,
+        ///  JournalEntry#value the ID of the piece it held.
+        CellChange,
+        /// @brief Changed bytes of Environment#variables. JournalEntry#index
+        ///  is their offset, JournalEntry#value their previous contents.
+        VariableChange,
+    };
+    /// @brief What the entry records.
+    Kind kind;
+    /// @brief The number of bytes of JournalEntry#value used by a JournalEntry::VariableChange.
+    uint8_t size;
+    /// @brief See JournalEntry::Kind.
+    int32_t index;
+    /// @brief See JournalEntry::Kind.
+    uint64_t value;
 };
 
 /// @brief Manages the current state of a game.
 /// @details
 ///  Keeps track of the current board and Variables, whose turn it is, generates
 ///  legal moves for the current player, and executes players' moves.
+///
+///  Everything that does not change during a game lives in a shared
+///  GameDefinition, so an Environment only holds the game's state and is
+///  cheap to create.
 /// @author Bjarni Dagur Thor Kárason
 class Environment
 {
   public:
-    /// @brief Environment constructor from game board size.
-    Environment(int board_size_x, int board_size_y);
+    /// @brief Environment constructor from a game definition.
+    /// @details Sets up the initial board of the game, with the first player to move.
+    ///
+    /// @param definition the game to play.
+    ///
+    /// @throw std::runtime_error if GameDefinition#max_move_length exceeds Move::max_steps.
+    explicit Environment(std::shared_ptr<const GameDefinition> definition);
     /// @brief Environment desctructor.
     ~Environment();
+    /// @brief The game being played.
+    const std::shared_ptr<const GameDefinition> definition;
     /// @brief The managed game board's size along the x axis of a Cartesian coordinate system.
     int board_size_x;
     /// @brief The managed game board's size along the y axis of a Cartesian coordinate system.
     int board_size_y;
     /// @brief Keeps track of how many moves have been made in the current game.
     int move_count;
+    /// @brief The width of the sentinel border around the board.
+    /// @see GameDefinition#border
+    int border;
+    /// @brief The distance between vertically adjacent cells in Environment#board.
+    int stride;
     /// @brief Keeps track of the current game board.
     /// @details
-    ///  First dimension of the vector corresponds to the x axis in a Cartesian
-    ///  coordinate system, second dimension of the vector corresponds to the y
-    ///  axis in a Cartesian coordinate system.
+    ///  A single contiguous array of cells in row-major order, where the board
+    ///  is surrounded by Environment#border rows and columns of sentinel cells.
+    ///  Use Environment::cell to access a Cell by its coordinates.
     ///
     /// @see Cell
-    std::vector<std::vector<Cell>> board;
-    /// @brief The pieces defined in the game description, which player they
-    ///  belong to, and how they can move.
-    /// @details
-    ///  A map that takes a piece's name and returns a list of the players it
-    ///  belongs to, and a state machine to generate legal moves for it.
-    ///  A map that takes a piece's name and returns the name of the player it
-    ///  belongs to, and a state machine to generate legal moves for it.
-    std::map<std::string, std::pair<std::vector<std::string>, std::unique_ptr<DFAState, DFAStateDeleter>>> pieces;
-    /// @brief The post conditions defined in the game description that must
-    ///  hold after a player makes a move.
-    /// @details
-    ///  A map that takes a player's name and returns a vector containing all of
-    ///  his post conditions as piece/state machine pairs.
-    ///
-    /// @note
-    ///  Post conditions are defined for player/piece pairs. After the player
-    ///  makes a move, all his post conditions are checked for each of the
-    ///  pieces they are defined for. Post conditions are defined using regular
-    ///  expressions, and a post condition holds if the corresponding regular
-    ///  expression is not matched.
-    std::map<std::string, std::vector<std::pair<std::string, std::unique_ptr<DFAState, DFAStateDeleter>>>>
-        post_conditions;
-    /// @brief The players defined in the game description.
-    std::vector<std::string> players;
-    /// @brief Keeps track of whose turn it is.
-    std::string current_player;
+    std::vector<Cell> board;
+    /// @brief True if the board has at most 64 cells, in which case the board
+    ///  is also kept as Bitboard.
+    /// @details
+    ///  Environment#piece_bitboards, Environment#player_bitboards and
+    ///  Environment#occupied are only maintained if this is true. Otherwise
+    ///  they are empty and Environment#piece_squares and
+    ///  Environment#player_squares are maintained instead.
+    bool has_bitboards;
+    /// @brief The cells holding each piece as a vector indexed by piece ID.
+    std::vector<Bitboard> piece_bitboards;
+    /// @brief The cells owned by each player as a vector indexed by player ID.
+    std::vector<Bitboard> player_bitboards;
+    /// @brief The cells owned by some player.
+    Bitboard occupied;
+    /// @brief The cells holding each piece as a vector indexed by piece ID.
+    /// @pre Environment#has_bitboards is false.
+    std::vector<SquareSet> piece_squares;
+    /// @brief The cells owned by each player as a vector indexed by player ID.
+    /// @pre Environment#has_bitboards is false.
+    std::vector<SquareSet> player_squares;
+    /// @brief Keeps track of whose turn it is as a player ID.
+    int current_player;
     /// @brief Keeps track of the Variables in the current game state.
     Variables variables;
+    /// @brief The Zobrist hash of the current game state.
+    /// @details
+    ///  Covers the piece on each Cell, whose turn it is, and the Variables the
+    ///  side effects choose to hash (see Environment::variable_key). It is
+    ///  updated incrementally by Environment::set_piece, when the turn changes,
+    ///  and by side effects that change hashed Variables, so it is never
+    ///  recomputed from the board.
+    uint64_t hash;
     /// @brief Checks if a Cell's coordinates are within the board's bounds.
     ///
     /// @param x the x coordinate of the Cell to check.
@@ -131,6 +335,69 @@ class Environment
     /// @returns true if Environment#board[\p x][\p y] exists.
     /// @returns false if Environment#board[\p x][\p y] does not exist.
     bool contains_cell(size_t x, size_t y);
+    /// @brief Returns the Cell at (\p x, \p y).
+    /// @details
+    ///  The first coordinate corresponds to the x axis in a Cartesian
+    ///  coordinate system, the second coordinate corresponds to the y axis in a
+    ///  Cartesian coordinate system.
+    ///
+    /// @pre (\p x, \p y) is on the board or at most Environment#border cells away from it.
+    Cell &cell(int x, int y) {
+        return board[(x + border) * stride + y + border];
+    }
+    /// @brief Returns the index of Cell (\p x, \p y) in a Bitboard.
+    int square(int x, int y) const {
+        return x * board_size_y + y;
+    }
+    /// @brief Removes the lowest cell from \p bitboard and returns its index.
+    ///
+    /// @pre \p bitboard is not empty.
+    static int pop_square(Bitboard &bitboard) {
+        int square = __builtin_ctzll(bitboard);
+        bitboard &= bitboard - 1;
+        return square;
+    }
+    /// @brief Returns the Bitboard of all cells in row \p x.
+    ///
+    /// @pre Environment#has_bitboards is true.
+    Bitboard row_bitboard(int x) const;
+    /// @brief Places a piece on a Cell.
+    /// @details
+    ///  Sets the Cell's piece, owners and state machine according to
+    ///  GameDefinition#pieces, and updates the bitboards. All changes to the
+    ///  board must go through this function to keep the bitboards in sync.
+    ///
+    /// @param x the x coordinate of the Cell.
+    /// @param y the y coordinate of the Cell.
+    /// @param piece the ID of the piece to place.
+    ///
+    /// @pre A move is being executed, see Environment::execute_move. The
+    ///  change is recorded in the move's undo journal.
+    void set_piece(int x, int y, int piece);
+    /// @brief Sets a member of Environment#variables.
+    /// @details
+    ///  Side effects must change Variables through this function so the change
+    ///  is recorded in the move's undo journal.
+    ///
+    /// @param variable a member of Environment#variables.
+    /// @param value the value to set.
+    ///
+    /// @pre A move is being executed, see Environment::execute_move.
+    template <typename T> void set_variable(T &variable, const T &value) {
+        static_assert(std::is_trivially_copy_constructible<T>::value && std::is_trivially_destructible<T>::value,
+                      "variables are journaled as raw bytes");
+        journal_variable(&variable, sizeof(T));
+        variable = value;
+    }
+    /// @brief Returns the Zobrist key of the user-defined variable key \p index.
+    /// @details
+    ///  Side effects that change a Variable which distinguishes game states,
+    ///  e.g. castling rights, XOR its key into Environment#hash when they
+    ///  execute. Undoing the move restores the hash. The indices are chosen by
+    ///  the game's side effects.
+    ///
+    /// @param index the index of the key, non-negative.
+    uint64_t variable_key(int index) const;
     /// @brief Returns a 3-dimensional representation of the current environment
     ///  for a neural network.
     ///
@@ -141,7 +408,99 @@ class Environment
     /// @returns a vector of legal moves.
     ///
     /// @see Step
-    std::vector<std::vector<Step>> generate_moves();
+    std::vector<Move> generate_moves();
+    /// @brief Generates all legal moves for Environment#current_player into a
+    ///  caller-owned vector.
+    /// @details
+    ///  Clears \p moves first. The vector keeps its capacity between calls, so
+    ///  reusing it does not allocate once it has grown large enough.
+    ///
+    /// @param moves the vector to store the legal moves in.
+    void generate_moves(std::vector<Move> &moves);
+    /// @brief Generates all legal moves for Environment#current_player into a MoveList.
+    /// @details
+    ///  Clears \p moves first. Never allocates.
+    ///
+    /// @param moves the list to store the legal moves in.
+    ///
+    /// @throw std::runtime_error if there are more than \p N legal moves.
+    template <int N> void generate_moves(MoveList<N> &moves) {
+        moves.clear();
+        visit_moves([&moves](const Move &move) {
+            if (moves.size() == N)
+                throw_move_list_full(N);
+            moves.push_back(move);
+        });
+    }
+    /// @brief Calls \p visitor with each legal move for Environment#current_player.
+    /// @details
+    ///  The moves are never stored. \p visitor is called in the middle of
+    ///  move generation, when the board may or may not hold the move's
+    ///  result, and must neither read nor change the Environment. Never
+    ///  allocates.
+    ///
+    /// @param visitor a callable taking a const Move &.
+    ///
+    /// @returns the number of legal moves.
+    template <typename Visitor> int visit_moves(Visitor &&visitor) {
+        auto visit = [](void *context, const Move &move) {
+            (*static_cast<std::remove_reference_t<Visitor> *>(context))(move);
+        };
+        return generate_moves(visit, const_cast<void *>(static_cast<const void *>(&visitor)), false);
+    }
+    /// @brief Counts the legal moves for Environment#current_player.
+    /// @details
+    ///  Like Environment::generate_moves, including the terminal condition
+    ///  check when there are none, but the moves are neither stored nor
+    ///  visited. Never allocates.
+    ///
+    /// @returns the number of legal moves.
+    int count_moves();
+    /// @brief Generates all pseudo-legal moves for Environment#current_player
+    ///  into a caller-owned vector.
+    /// @details
+    ///  Pseudo-legal moves are the moves the pieces' DFAs allow, without
+    ///  checking the post conditions. Use Environment::is_legal to check a
+    ///  single move, e.g. the one a rollout picks, or Environment::legalize
+    ///  to get the legal moves.
+    ///
+    ///  Clears \p moves first. If there are no pseudo-legal moves, there are
+    ///  no legal moves either and the terminal conditions are checked as by
+    ///  Environment::generate_moves.
+    ///
+    /// @param moves the vector to store the pseudo-legal moves in.
+    void generate_pseudo_legal_moves(std::vector<Move> &moves);
+    /// @brief Calls \p visitor with each pseudo-legal move for Environment#current_player.
+    /// @details
+    ///  See Environment::visit_moves and Environment::generate_pseudo_legal_moves.
+    ///
+    /// @param visitor a callable taking a const Move &.
+    ///
+    /// @returns the number of pseudo-legal moves.
+    template <typename Visitor> int visit_pseudo_legal_moves(Visitor &&visitor) {
+        auto visit = [](void *context, const Move &move) {
+            (*static_cast<std::remove_reference_t<Visitor> *>(context))(move);
+        };
+        return generate_moves(visit, const_cast<void *>(static_cast<const void *>(&visitor)), true);
+    }
+    /// @brief Checks if a pseudo-legal move satisfies all post conditions.
+    /// @details
+    ///  Executes \p move, checks the post conditions of
+    ///  Environment#current_player and undoes the move.
+    ///
+    /// @param move a pseudo-legal move in the current state.
+    ///
+    /// @returns true if \p move is legal.
+    bool is_legal(const Move &move);
+    /// @brief Removes the moves that are not legal from a list of pseudo-legal moves.
+    /// @details
+    ///  Leaves the Environment as Environment::generate_moves would, so if no
+    ///  legal moves remain the terminal conditions are checked.
+    ///
+    /// @param moves the pseudo-legal moves in the current state.
+    ///
+    /// @returns the number of legal moves.
+    int legalize(std::vector<Move> &moves);
     /// @brief Executes \p move in the current Environment state.
     /// @details
     ///  Automatically updates whose turn it is.
@@ -153,10 +512,11 @@ class Environment
     ///  Environment::Variables.
     ///
     ///  @pre \p move is a legal move in the current state.
-    void execute_move(const std::vector<Step> &move, bool searching = false);
+    void execute_move(const Move &move, bool searching = false);
     /// @brief Undos the last move.
     /// @details
-    ///  Sets the game state to the state before the move.
+    ///  Sets the game state to the state before the move by rewinding the
+    ///  undo journal to the move's start.
     ///
     /// @param searching true if moves are being generated, false otherwise.
     ///
@@ -180,39 +540,184 @@ class Environment
     void print();
     /// @brief Return a json representation of the envirnment for the GUI service.
     std::string jsonify();
+    /// @brief Reports Environment#candidate_move as a legal move if all post conditions hold.
+    /// @details
+    ///  Called when move generation reaches an accepting DFA state. Together
+    ///  with Environment::push_step and Environment::pop_step, this is what
+    ///  move generators compiled ahead of time use to build moves, see
+    ///  GameDefinition#move_generator.
+    ///
+    /// @pre Moves are being generated.
+    void accept_candidate_move();
+    /// @brief Reports Environment#candidate_move extended by a last step from
+    ///  (x, y) to (next_x, next_y) as a legal move if all post conditions hold.
+    /// @details
+    ///  Called instead of Environment::push_step when the step completes the
+    ///  move. The step is only executed if post conditions have to be checked
+    ///  on the resulting board, see Environment#apply_final_steps. Whether
+    ///  they do is decided per player, not per edge: in games where the
+    ///  player has post conditions, such as chess, the step is always
+    ///  executed and undone when generating legal moves. Only pseudo-legal
+    ///  move generation and players without post conditions skip it.
+    ///
+    /// @param x the x coordinate the piece is leaving.
+    /// @param y the y coordinate the piece is leaving.
+    /// @param next_x the x coordinate the piece is going to.
+    /// @param next_y the y coordinate the piece is going to.
+    /// @param side_effect the ID of the step's SideEffect.
+    ///
+    /// @pre Moves are being generated and the piece is at (x, y).
+    void accept_final_step(int x, int y, int next_x, int next_y, int side_effect);
+    /// @brief Extends Environment#candidate_move by a step from (x, y) to
+    ///  (next_x, next_y) and executes the step.
+    ///
+    /// @param x the x coordinate the piece is leaving.
+    /// @param y the y coordinate the piece is leaving.
+    /// @param next_x the x coordinate the piece is going to.
+    /// @param next_y the y coordinate the piece is going to.
+    /// @param side_effect the ID of the step's SideEffect.
+    ///
+    /// @pre Moves are being generated and the piece is at (x, y).
+    void push_step(int x, int y, int next_x, int next_y, int side_effect);
+    /// @brief Undoes and removes the last step of Environment#candidate_move.
+    ///
+    /// @pre The last step was added by Environment::push_step.
+    void pop_step();
 
   private:
+    /// @brief A function that receives the moves found by Environment::generate_moves.
+    ///
+    /// @param context the context passed to Environment::generate_moves.
+    /// @param move a legal move.
+    typedef void (*MoveSink)(void *context, const Move &move);
+    /// @brief Generates all legal moves for Environment#current_player.
+    /// @details
+    ///  All public move generation functions go through this one.
+    ///
+    /// @param sink called with each legal move.
+    /// @param context passed to \p sink.
+    /// @param pseudo_legal true to skip the post conditions and find pseudo-legal moves.
+    ///
+    /// @returns the number of moves found.
+    int generate_moves(MoveSink sink, void *context, bool pseudo_legal);
+    /// @brief Throws the error for a full MoveList.
+    ///
+    /// @param capacity the capacity of the MoveList.
+    [[noreturn]] static void throw_move_list_full(int capacity);
     /// @brief Verifies that all post condition hold.
     ///
     /// @returns true if all post conditions holds.
     /// @returns false if some post condition does not hold.
     bool verify_post_conditions();
+    /// @brief The routines of an Environment that are specialized for the board's size.
+    /// @details
+    ///  Each routine is an instantiation for some BoardGeometry of the member
+    ///  template with the same name.
+    ///
+    /// @see Environment::select_geometry
+    struct GeometryRoutines {
+        /// @brief Generates the moves of all pieces of the current player.
+        void (Environment::*generate_all_moves)();
+        /// @brief Verifies that all post condition hold.
+        bool (Environment::*verify_post_conditions)();
+        /// @brief Executes the side effects of the steps of a move.
+        void (Environment::*execute_steps)(const Move &move);
+        /// @brief Rewinds the undo journal to the start of the last move.
+        void (Environment::*rewind_journal)();
+    };
+    /// @brief Returns the routines specialized for a board of the given size and border.
+    /// @details
+    ///  The common board sizes 3x3, 4x4, 6x7, 7x6 and 8x8 with a border of 1,
+    ///  and 8x8 with a border of 2, have routines where the size and border
+    ///  are constants. Other boards get routines that read them at run time.
+    ///
+    /// @param board_size_x the board's size along the x axis.
+    /// @param board_size_y the board's size along the y axis.
+    /// @param border the width of the sentinel border around the board.
+    static const GeometryRoutines *select_geometry(int board_size_x, int board_size_y, int border);
+    /// @brief Generates the moves of all pieces of the current player.
+    /// @details
+    ///  Uses GameDefinition#move_generator if the game's DFAs have been
+    ///  compiled, and Environment::generate_moves otherwise.
+    ///
+    /// @tparam Geometry the BoardGeometry of the board.
+    template <typename Geometry> void generate_all_moves();
+    /// @brief Verifies that all post condition hold.
+    /// @details
+    ///  Uses GameDefinition#post_condition_checker if the game's DFAs have been
+    ///  compiled, and Environment::verify_post_condition otherwise.
+    ///
+    /// @tparam Geometry the BoardGeometry of the board.
+    template <typename Geometry> bool verify_post_conditions();
     /// @brief Verifies that a post condition holds.
     ///
-    /// @param state the root of the post condition's DFA to check.
-    /// @param x the x coordinate of the Cell to check the post condition from.
-    /// @param y the y coordinate of the Cell to check the post condition from.
+    /// @param geometry the geometry of the board.
+    /// @param state the current state in GameDefinition#transitions of the post condition's DFA.
+    /// @param square the square of the Cell to check the post condition from, see Environment::square.
     ///
     /// @returns true if the post condition holds.
     /// @returns false if the post condition does not hold.
-    bool verify_post_condition(DFAState *state, int x, int y);
+    template <typename Geometry> bool verify_post_condition(const Geometry &geometry, int state, int square);
+    /// @brief Generates the moves of the piece on a Cell owned by the current player.
+    ///
+    /// @param geometry the geometry of the board.
+    /// @param square the Cell's square, see Environment::square.
+    template <typename Geometry> void generate_piece_moves(const Geometry &geometry, int square);
     /// @brief Helper function for Environment::generate_moves.
     ///
-    /// @param state the current state of a DFA that generates legal moves for a piece.
-    /// @param x the current x coordinate of the piece.
-    /// @param y the current y coordinate of the piece.
-    void generate_moves(DFAState *state, int x, int y);
+    /// @param geometry the geometry of the board.
+    /// @param state the current state in GameDefinition#transitions of a DFA
+    ///  that generates legal moves for a piece.
+    /// @param square the current square of the piece, see Environment::square.
+    template <typename Geometry> void generate_moves(const Geometry &geometry, int state, int square);
+    /// @brief Executes the side effects of the steps of \p move.
+    ///
+    /// @tparam Geometry the BoardGeometry of the board.
+    template <typename Geometry> void execute_steps(const Move &move);
+    /// @brief Rewinds the undo journal to the start of the last move.
+    ///
+    /// @tparam Geometry the BoardGeometry of the board.
+    template <typename Geometry> void rewind_journal();
+    /// @brief Lays out the initial board and surrounds it with a sentinel border.
+    /// @details
+    ///  Also initializes the bitboards if the board has at most 64 cells, and
+    ///  the hash.
+    void set_board();
+    /// @brief Places a piece on a Cell without recording it in the undo journal.
+    /// @see Environment::set_piece
+    void place_piece(int x, int y, int piece);
+    /// @brief Records bytes of Environment#variables in the undo journal.
+    ///
+    /// @param variable the first byte, inside Environment#variables.
+    /// @param size the number of bytes.
+    void journal_variable(const void *variable, size_t size);
     /// @brief Updates whose turn it is.
     void update_current_player();
-    /// @brief Stores found moves during move generation.
-    std::vector<std::vector<Step>> found_moves;
+    /// @brief The routines specialized for the board's size, see Environment::select_geometry.
+    const GeometryRoutines *geometry_routines;
+    /// @brief Receives found moves during move generation.
+    MoveSink move_sink;
+    /// @brief The context passed to Environment#move_sink.
+    void *move_sink_context;
+    /// @brief Counts found moves during move generation.
+    int n_found_moves;
+    /// @brief True if found moves must satisfy the post conditions, false
+    ///  when generating pseudo-legal moves.
+    bool check_post_conditions;
+    /// @brief True if the last step of a move must be executed before the
+    ///  move is reported, because post conditions read the resulting board.
+    /// @details
+    ///  Set whenever legal moves are generated for a player with any post
+    ///  condition, regardless of which cells the post conditions read.
+    /// @see Environment::accept_final_step
+    bool apply_final_steps;
     /// @brief Stores intermediate moves during move generation.
-    std::vector<Step> candidate_move;
-    /// @brief Stores the side effects executed in the environment in a reverse
-    ///  order.
-    std::stack<std::shared_ptr<SideEffect>> side_effect_stack;
-    /// @brief Stores how many side effects were executed in each move, and how
-    ///  many legal moves were possible.
+    Move candidate_move;
+    /// @brief The cells owned by the current player when move generation
+    ///  started, since Environment#player_squares is reordered by the moves
+    ///  tried while generating.
+    std::vector<int> origin_squares;
+    /// @brief The undo journal of all executed moves, oldest first.
     /// @details Required to correctly undo a move and search the game tree.
-    std::stack<std::pair<int, int>> counter_stack;
+    std::vector<JournalEntry> journal;
 };
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+#include "game_definition.hpp"
+
+GameDefinition::GameDefinition(int board_size_x, int board_size_y)
+    : board_size_x(board_size_x), board_size_y(board_size_y), border(0), move_generator(nullptr),
+      post_condition_checker(nullptr), default_side_effect(0), max_move_length(1) {}
+GameDefinition::~GameDefinition() {}
+
+void GameDefinition::set_transitions() {
+    for (const auto &piece : pieces) {
+        piece_states.push_back(transitions.add_dfa(piece.second.get()));
+    }
+    for (const auto &player_post_conditions : post_conditions) {
+        post_condition_states.emplace_back();
+        for (const auto &post_condition : player_post_conditions) {
+            int state = transitions.add_dfa(post_condition.second.get());
+            post_condition_states.back().push_back({post_condition.first, state});
+        }
+    }
+    transitions.set_board(board_size_x, board_size_y);
+    auto it = compiled_dfas().find(fingerprint());
+    if (it != compiled_dfas().end()) {
+        move_generator = it->second.first;
+        post_condition_checker = it->second.second;
+    }
+}
+
+uint64_t GameDefinition::fingerprint() const {
+    uint64_t hash = 0;
+    auto mix = [&hash](uint64_t value) { hash = zobrist_key(hash ^ value); };
+    mix(board_size_x);
+    mix(board_size_y);
+    mix(border);
+    for (int state : piece_states) {
+        mix(state);
+    }
+    for (const auto &player_post_conditions : post_condition_states) {
+        for (const auto &post_condition : player_post_conditions) {
+            mix(post_condition.first);
+            mix(post_condition.second);
+        }
+        mix(~0ULL);
+    }
+    for (int state = 0; state < transitions.size(); state++) {
+        mix(transitions.is_accepting(state));
+        for (const DFAEdge *edge = transitions.begin(state); edge != transitions.end(state); edge++) {
+            mix(edge->target);
+            mix(static_cast<uint8_t>(edge->dx));
+            mix(static_cast<uint8_t>(edge->dy));
+            mix(edge->predicate);
+            mix(edge->side_effect);
+        }
+        mix(~0ULL);
+    }
+    return hash;
+}
+
+bool GameDefinition::register_compiled_dfas(uint64_t fingerprint, MoveGenerator generator,
+                                            PostConditionChecker checker) {
+    compiled_dfas()[fingerprint] = {generator, checker};
+    return true;
+}
+
+std::map<uint64_t, std::pair<MoveGenerator, PostConditionChecker>> &GameDefinition::compiled_dfas() {
+    static std::map<uint64_t, std::pair<MoveGenerator, PostConditionChecker>> registry;
+    return registry;
+}
+
+void GameDefinition::set_zobrist_keys() {
+    piece_keys.resize(pieces.size() * board_size_x * board_size_y);
+    for (size_t i = 0; i < piece_keys.size(); i++) {
+        piece_keys[i] = zobrist_key(i);
+    }
+    player_keys.resize(Symbols::max_players);
+    for (int i = 0; i < Symbols::max_players; i++) {
+        player_keys[i] = zobrist_key(piece_keys.size() + i);
+    }
+}
+
+uint64_t GameDefinition::variable_key(int index) const {
+    return zobrist_key(piece_keys.size() + Symbols::max_players + index);
+}
+
+uint64_t GameDefinition::zobrist_key(uint64_t index) {
+    uint64_t z = (index + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+/**
+ *  @file game_definition.hpp
+ *  @brief Defines the immutable description of a game shared by all its environments.
+ *  @author Bjarni Dagur Thor Kárason
+ *  @see Environment
+ */
+#pragma once
+
+#include "dfa.hpp"
+#include "dfa_table.hpp"
+#include "symbols.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class Environment;
+
+/// @brief A function that generates the moves of a piece from a DFA state,
+///  compiled ahead of time from a game description.
+/// @details
+///  Behaves like interpreting GameDefinition#transitions from \p state for the
+///  piece at (x, y), see GameDefinition#move_generator.
+typedef void (*MoveGenerator)(Environment *environment, int state, int x, int y);
+/// @brief A function that checks a post condition from a DFA state, compiled
+///  ahead of time from a game description.
+/// @details
+///  Behaves like interpreting GameDefinition#transitions from \p state for the
+///  post condition at (x, y), see GameDefinition#post_condition_checker.
+///
+/// @returns true if the post condition holds.
+typedef bool (*PostConditionChecker)(Environment *environment, int state, int x, int y);
+
+/// @brief Everything about a game that does not change while it is played.
+/// @details
+///  Holds the players, the pieces and their state machines, the post
+///  conditions, the initial board and the Zobrist keys. A GameDefinition is
+///  created once by the Parser and never changes afterwards, so any number of
+///  Environment instances, on any number of threads, can share it through a
+///  std::shared_ptr and be created without parsing the game description again.
+///
+/// @see Environment
+/// @see Parser::get_game_definition
+///
+/// @author Bjarni Dagur Thor Kárason
+class GameDefinition
+{
+  public:
+    /// @brief GameDefinition constructor from game board size.
+    GameDefinition(int board_size_x, int board_size_y);
+    /// @brief GameDefinition destructor.
+    ~GameDefinition();
+    GameDefinition(const GameDefinition &) = delete;
+    GameDefinition &operator=(const GameDefinition &) = delete;
+    /// @brief The game board's size along the x axis of a Cartesian coordinate system.
+    int board_size_x;
+    /// @brief The game board's size along the y axis of a Cartesian coordinate system.
+    int board_size_y;
+    /// @brief The width of the sentinel border around the board.
+    /// @details
+    ///  Computed at parse time as the largest \p dx or \p dy used by any rule
+    ///  or post condition, so every DFA transition from a Cell on the board
+    ///  lands on the board or on a sentinel Cell.
+    int border;
+    /// @brief The IDs of the players defined in the game description, in turn order.
+    std::vector<int> players;
+    /// @brief The pieces defined in the game description, which player they
+    ///  belong to, and how they can move.
+    /// @details
+    ///  A vector indexed by piece ID that returns the set of players the piece
+    ///  belongs to (see Cell#owners), and a state machine to generate legal
+    ///  moves for it. Pieces that are not defined in the game description
+    ///  belong to no player and have no state machine.
+    std::vector<std::pair<unsigned int, std::unique_ptr<DFAState, DFAStateDeleter>>> pieces;
+    /// @brief The IDs of the pieces defined in the game description, sorted by name.
+    std::vector<int> declared_pieces;
+    /// @brief The post conditions defined in the game description that must
+    ///  hold after a player makes a move.
+    /// @details
+    ///  A vector indexed by player ID that returns a vector containing all of
+    ///  his post conditions as piece ID/state machine pairs.
+    ///
+    /// @note
+    ///  Post conditions are defined for player/piece pairs. After the player
+    ///  makes a move, all his post conditions are checked for each of the
+    ///  pieces they are defined for. Post conditions are defined using regular
+    ///  expressions, and a post condition holds if the corresponding regular
+    ///  expression is not matched.
+    std::vector<std::vector<std::pair<int, std::unique_ptr<DFAState, DFAStateDeleter>>>> post_conditions;
+    /// @brief The DFAs of GameDefinition#pieces and GameDefinition#post_conditions
+    ///  flattened into a single table, which move generation runs off.
+    DFATable transitions;
+    /// @brief The initial state in GameDefinition#transitions of each piece's
+    ///  DFA, indexed by piece ID.
+    std::vector<int> piece_states;
+    /// @brief GameDefinition#post_conditions as piece ID/initial state in
+    ///  GameDefinition#transitions pairs, indexed by player ID.
+    std::vector<std::vector<std::pair<int, int>>> post_condition_states;
+    /// @brief The move generator compiled ahead of time for this game, or
+    ///  nullptr if moves are generated by interpreting GameDefinition#transitions.
+    /// @details
+    ///  Set by GameDefinition::set_transitions if compiled DFAs have been
+    ///  registered for GameDefinition::fingerprint.
+    ///
+    /// @see GameDefinition::register_compiled_dfas
+    MoveGenerator move_generator;
+    /// @brief The post condition checker compiled ahead of time for this game,
+    ///  or nullptr if post conditions are checked by interpreting
+    ///  GameDefinition#transitions.
+    ///
+    /// @see GameDefinition::register_compiled_dfas
+    PostConditionChecker post_condition_checker;
+    /// @brief The side effects available to game descriptions, indexed by side effect ID.
+    /// @details
+    ///  Moves refer to side effects by their ID, see Step#side_effect and
+    ///  SideEffect::get_id.
+    std::vector<const SideEffect *> side_effects;
+    /// @brief The ID of the Default side effect.
+    int default_side_effect;
+    /// @brief The largest number of steps in a move, including the initial position.
+    /// @details
+    ///  Computed at parse time from the pieces' state machines. An Environment
+    ///  refuses games whose moves do not fit in Move::max_steps.
+    int max_move_length;
+    /// @brief The IDs of the pieces on the initial board in row-major order.
+    std::vector<int> initial_board;
+    /// @brief The Zobrist keys of each piece on each Cell, indexed by
+    ///  piece ID * board size + Environment::square.
+    std::vector<uint64_t> piece_keys;
+    /// @brief The Zobrist keys of whose turn it is, indexed by player ID.
+    std::vector<uint64_t> player_keys;
+    /// @brief Generates GameDefinition#transitions, GameDefinition#piece_states
+    ///  and GameDefinition#post_condition_states, and resolves the edges of
+    ///  GameDefinition#transitions for every square, see DFATable::set_board.
+    ///
+    /// @pre GameDefinition#pieces, GameDefinition#post_conditions and the
+    ///  board size have been set.
+    void set_transitions();
+    /// @brief Returns a hash of everything compiled DFAs depend on.
+    /// @details
+    ///  Covers the board size, the border, GameDefinition#transitions,
+    ///  GameDefinition#piece_states and GameDefinition#post_condition_states,
+    ///  so compiled DFAs are only used for the game description they were
+    ///  compiled from.
+    ///
+    /// @pre GameDefinition::set_transitions has been called.
+    uint64_t fingerprint() const;
+    /// @brief Registers DFAs compiled ahead of time.
+    /// @details
+    ///  Called during static initialization by the code that
+    ///  codegen-abstract-board-games generates.
+    ///
+    /// @param fingerprint the GameDefinition::fingerprint of the game the DFAs were compiled from.
+    /// @param generator the compiled move generator.
+    /// @param checker the compiled post condition checker.
+    ///
+    /// @returns true.
+    static bool register_compiled_dfas(uint64_t fingerprint, MoveGenerator generator, PostConditionChecker checker);
+    /// @brief Generates GameDefinition#piece_keys and GameDefinition#player_keys.
+    ///
+    /// @pre GameDefinition#pieces has been set.
+    void set_zobrist_keys();
+    /// @brief Returns the Zobrist key of the user-defined variable key \p index.
+    ///
+    /// @see Environment::variable_key
+    uint64_t variable_key(int index) const;
+
+  private:
+    /// @brief Returns the registered compiled DFAs by fingerprint.
+    static std::map<uint64_t, std::pair<MoveGenerator, PostConditionChecker>> &compiled_dfas();
+    /// @brief Returns a pseudorandom Zobrist key for \p index.
+    /// @details
+    ///  Uses the splitmix64 generator, so keys are the same in every run.
+    static uint64_t zobrist_key(uint64_t index);
+};
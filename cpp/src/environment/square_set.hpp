@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+/**
+ *  @file square_set.hpp
+ *  @brief Defines a set of board cells with constant time updates.
+ *  @author Bjarni Dagur Thor Kárason
+ */
+#pragma once
+
+#include <vector>
+
+/// @brief A set of cells on a board, identified by Environment::square.
+/// @details
+///  Keeps the cells in a dense array, and the position of each cell in that
+///  array, so inserting, removing and testing a cell take constant time and
+///  iterating takes time proportional to the number of cells in the set.
+///  Removing a cell moves the last cell of the array into its place, so
+///  updates change the iteration order.
+///
+///  Used instead of Bitboard on boards with more than 64 cells.
+///
+/// @author Bjarni Dagur Thor Kárason
+class SquareSet
+{
+  public:
+    /// @brief SquareSet constructor.
+    SquareSet() = default;
+    /// @brief SquareSet constructor for a board of \p n_cells cells.
+    explicit SquareSet(int n_cells) : position(n_cells, -1) {}
+    /// @brief Returns the number of cells in the set.
+    int size() const {
+        return squares.size();
+    }
+    /// @brief Returns true if the set has no cells.
+    bool empty() const {
+        return squares.empty();
+    }
+    /// @brief Returns true if \p square is in the set.
+    bool contains(int square) const {
+        return position[square] != -1;
+    }
+    /// @brief Returns the \p i-th cell in the set.
+    int operator[](int i) const {
+        return squares[i];
+    }
+    /// @brief Adds \p square to the set.
+    ///
+    /// @pre \p square is not in the set.
+    void insert(int square) {
+        position[square] = squares.size();
+        squares.push_back(square);
+    }
+    /// @brief Removes \p square from the set.
+    ///
+    /// @pre \p square is in the set.
+    void erase(int square) {
+        int last = squares.back();
+        squares[position[square]] = last;
+        position[last] = position[square];
+        squares.pop_back();
+        position[square] = -1;
+    }
+    /// @brief Returns an iterator to the first cell.
+    std::vector<int>::const_iterator begin() const {
+        return squares.begin();
+    }
+    /// @brief Returns an iterator past the last cell.
+    std::vector<int>::const_iterator end() const {
+        return squares.end();
+    }
+
+  private:
+    /// @brief The cells in the set.
+    std::vector<int> squares;
+    /// @brief The index of each cell of the board in SquareSet#squares, or -1 if it is not in the set.
+    std::vector<int> position;
+};
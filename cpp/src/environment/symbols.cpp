@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+#include "symbols.hpp"
+#include <stdexcept>
+
+int Symbols::get_piece_id(const std::string &name) {
+    return intern(pieces(), name);
+}
+
+const std::string &Symbols::get_piece_name(int id) {
+    return lookup(pieces(), id);
+}
+
+int Symbols::get_piece_count() {
+    std::lock_guard<std::mutex> lock(mutex());
+    return pieces().names.size();
+}
+
+int Symbols::get_player_id(const std::string &name) {
+    int id = intern(players(), name);
+    if (id >= max_players)
+        throw std::runtime_error("Too many players. At most " + std::to_string(max_players) + " are supported.");
+    return id;
+}
+
+int Symbols::find_player_id(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex());
+    auto it = players().ids.find(name);
+    return it != players().ids.end() ? it->second : -1;
+}
+
+const std::string &Symbols::get_player_name(int id) {
+    return lookup(players(), id);
+}
+
+int Symbols::intern(Table &table, const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex());
+    auto it = table.ids.find(name);
+    if (it != table.ids.end())
+        return it->second;
+    int id = table.names.size();
+    table.ids[name] = id;
+    table.names.push_back(name);
+    return id;
+}
+
+const std::string &Symbols::lookup(Table &table, int id) {
+    std::lock_guard<std::mutex> lock(mutex());
+    return table.names.at(id);
+}
+
+// The tables are function-local statics so they are initialized before the
+// predicates, side effects and terminal conditions that intern names when
+// they are constructed during static initialization.
+Symbols::Table &Symbols::pieces() {
+    static Table table;
+    return table;
+}
+
+Symbols::Table &Symbols::players() {
+    static Table table;
+    return table;
+}
+
+std::mutex &Symbols::mutex() {
+    static std::mutex m;
+    return m;
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+/**
+ *  @file symbols.hpp
+ *  @brief Interns piece and player names as small integer IDs.
+ *  @author Bjarni Dagur Thor Kárason
+ */
+#pragma once
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+/// @brief Interns piece and player names as small integer IDs.
+/// @details
+///  The board, predicates, side effects and terminal conditions work on piece
+///  and player IDs, and names are only looked up for printing. Names are
+///  interned process-wide, so a predicate can resolve the names it refers to
+///  once when it is constructed and compare integers afterwards.
+///
+///  Piece IDs and player IDs are assigned separately, starting from 0 in the
+///  order the names are first interned. Player IDs are used as bit positions in
+///  Cell#owners, so at most Symbols::max_players distinct player names can be
+///  interned.
+///
+/// @author Bjarni Dagur Thor Kárason
+class Symbols
+{
+  public:
+    /// @brief The maximum number of distinct player names.
+    static constexpr int max_players = 32;
+    /// @brief Returns the ID of a piece name, interning it if necessary.
+    ///
+    /// @param name the piece's name.
+    static int get_piece_id(const std::string &name);
+    /// @brief Returns the name of the piece with ID \p id.
+    ///
+    /// @pre \p id was returned by Symbols::get_piece_id.
+    static const std::string &get_piece_name(int id);
+    /// @brief Returns the number of interned piece names.
+    static int get_piece_count();
+    /// @brief Returns the ID of a player name, interning it if necessary.
+    ///
+    /// @param name the player's name.
+    ///
+    /// @throw std::runtime_error if more than Symbols::max_players player names are interned.
+    static int get_player_id(const std::string &name);
+    /// @brief Returns the ID of a player name without interning it.
+    ///
+    /// @param name the player's name.
+    ///
+    /// @returns the player's ID, or -1 if \p name has not been interned.
+    static int find_player_id(const std::string &name);
+    /// @brief Returns the name of the player with ID \p id.
+    ///
+    /// @pre \p id was returned by Symbols::get_player_id.
+    static const std::string &get_player_name(int id);
+
+  private:
+    /// @brief A table of interned names.
+    struct Table {
+        /// @brief Maps names to IDs.
+        std::map<std::string, int> ids;
+        /// @brief Maps IDs to names.
+        /// @details A std::deque so references to names stay valid while new names are interned.
+        std::deque<std::string> names;
+    };
+    /// @brief Interns \p name in \p table.
+    static int intern(Table &table, const std::string &name);
+    /// @brief Returns the name with ID \p id in \p table.
+    static const std::string &lookup(Table &table, int id);
+    /// @brief The interned piece names.
+    static Table &pieces();
+    /// @brief The interned player names.
+    static Table &players();
+    /// @brief Serializes access to the tables.
+    static std::mutex &mutex();
+};
@@ -7,7 +7,10 @@
  *  @brief A benchmarking tool using the flat Monte-Carlo measure.
  *  @author Bjarni Dagur Thor Kárason
  */
+#include "allocation_counter.hpp"
 #include "parser.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <climits>
@@ -17,59 +20,136 @@
 #include <iostream>
 #include <random>
 #include <string>
+#include <thread>
+
+/// @brief The number of states a rollout thread visits between checks of the stop flag.
+const int stop_check_interval = 256;
+
+/// @brief What a rollout thread counted.
+struct RolloutCounts {
+    /// @brief The number of games started.
+    long long game_count = 0;
+    /// @brief The number of states visited.
+    long long state_count = 0;
+};
+
+/// @brief Plays random games with an Environment of its own until \p stop is set.
+/// @details
+///  \p stop is only checked every stop_check_interval states, so the thread
+///  neither reads the clock nor touches shared memory in between.
+///
+/// @param definition the game to play.
+/// @param seed the seed of the thread's random number generator.
+/// @param stop set by the main thread when the time runs out.
+/// @param counts what the thread counted.
+void run_rollouts(std::shared_ptr<const GameDefinition> definition, unsigned int seed, const std::atomic<bool> &stop,
+                  RolloutCounts &counts) {
+    Environment env(definition);
+    std::mt19937 rng(seed);
+    std::vector<Move> found_moves;
+    long long game_count = 0;
+    long long state_count = 0;
+    bool time_left = true;
+    while (time_left) {
+        game_count++;
+        env.reset();
+        while (!env.variables.game_over) {
+            state_count++;
+
+            if (state_count % stop_check_interval == 0 && stop.load(std::memory_order_relaxed)) {
+                time_left = false;
+                break;
+            }
+
+            // Pick a pseudo-legal move at random and only check whether that
+            // one is legal. Discarding illegal picks keeps the choice uniform
+            // over the legal moves.
+            env.generate_pseudo_legal_moves(found_moves);
+            while (!found_moves.empty()) {
+                std::uniform_int_distribution<int> uni(0, found_moves.size() - 1);
+                int chosen = uni(rng);
+                if (env.is_legal(found_moves[chosen])) {
+                    env.execute_move(found_moves[chosen]);
+                    break;
+                }
+                found_moves[chosen] = found_moves.back();
+                found_moves.pop_back();
+                if (found_moves.empty())
+                    env.legalize(found_moves);
+            }
+        }
+    }
+    counts.game_count = game_count;
+    counts.state_count = state_count;
+}
 
 /// @brief Takes an Abstract Boardgame description and timelimit in
 ///  milliseconds, and runs flat Monte-Carlo rollouts until the time runs out.
 ///  Prints relevant statistics.
+/// @details
+///  With --threads N, N threads play rollouts at the same time, each with
+///  its own Environment and random number generator, and the statistics are
+///  summed over the threads.
 /// @author Bjarni Dagur Thor Kárason
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <gamefile> <timelimit>" << std::endl;
+    const char *usage = " <gamefile> <timelimit> [--threads N]";
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << usage << std::endl;
         return EXIT_FAILURE;
     }
+    int n_threads = 1;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            n_threads = std::stoi(argv[++i]);
+            if (n_threads < 1) {
+                std::cerr << "The number of threads must be positive" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0] << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
     int n_ms = std::stoi(argv[2]);
     assert(n_ms > 0);
 
     std::random_device rd;
-    std::mt19937 rng(rd());
 
     Parser parser(argv[1]);
     parser.parse();
-    std::unique_ptr<Environment> env = parser.get_environment();
+    std::shared_ptr<const GameDefinition> definition = parser.get_game_definition();
 
-    int game_count = 0;
-    long long int state_count = 0;
-    bool time_left = true;
+    std::atomic<bool> stop(false);
+    std::vector<RolloutCounts> thread_counts(n_threads);
+    std::vector<std::thread> workers;
+    long long start_allocations = AllocationCounter::get_count();
     auto start_time = std::chrono::system_clock::now();
-    while (time_left) {
-        game_count++;
-        env->reset();
-        while (!env->variables.game_over) {
-            state_count++;
-
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start_time)
-                    .count() > n_ms) {
-                time_left = false;
-                break;
-            }
-
-            std::vector<std::vector<Step>> found_moves = env->generate_moves();
+    for (int t = 0; t < n_threads; t++)
+        workers.emplace_back(run_rollouts, definition, rd(), std::cref(stop), std::ref(thread_counts[t]));
+    std::this_thread::sleep_until(start_time + std::chrono::milliseconds(n_ms));
+    stop.store(true, std::memory_order_relaxed);
+    for (std::thread &worker : workers)
+        worker.join();
+    auto end_time = std::chrono::system_clock::now();
+    long long n_allocations = AllocationCounter::get_count() - start_allocations;
 
-            if (!found_moves.empty()) {
-                std::uniform_int_distribution<int> uni(0, found_moves.size() - 1);
-                const std::vector<Step> &chosen_move = found_moves[uni(rng)];
-                env->execute_move(chosen_move);
-            }
-        }
+    long long game_count = 0;
+    long long state_count = 0;
+    for (const RolloutCounts &counts : thread_counts) {
+        game_count += counts.game_count;
+        state_count += counts.state_count;
     }
-    auto end_time = std::chrono::system_clock::now();
     double running_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
     std::cout << "Running time (ms): " << running_time << std::endl;
     std::cout << "Games played: " << game_count << std::endl;
     std::cout << "Games/s: " << game_count / running_time * 1000 << std::endl;
     std::cout << "States visited: " << state_count << std::endl;
     std::cout << "States/s: " << state_count / running_time * 1000 << std::endl;
+    std::cout << "Threads: " << n_threads << std::endl;
+    std::cout << "Heap allocations: " << n_allocations << std::endl;
 
     return EXIT_SUCCESS;
 }
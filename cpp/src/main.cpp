@@ -38,15 +38,16 @@ int main(int argc, char *argv[]) {
     while (!env->variables.game_over) {
         if (move_count != 0)
             std::cout << "\n\n\n";
-        std::cout << env->current_player << " turn:" << std::endl;
+        std::cout << env->get_current_player() << " turn:" << std::endl;
         env->print();
 
-        std::vector<std::vector<Step>> found_moves = env->generate_moves();
+        std::vector<Move> found_moves = env->generate_moves();
         int i = 0;
-        for (const std::vector<Step> &move : found_moves) {
+        for (const Move &move : found_moves) {
             std::cout << i++ << ") ";
             for (const Step &step : move) {
-                std::cout << "(" << step.x << ", " << step.y << "){" << step.side_effect->get_name() << "} ";
+                std::cout << "(" << step.cell / env->board_size_y << ", " << step.cell % env->board_size_y << "){"
+                          << env->definition->side_effects[step.side_effect]->get_name() << "} ";
             }
             std::cout << std::endl;
         }
@@ -72,10 +73,11 @@ int main(int argc, char *argv[]) {
                 else {
                     move_num = std::stoi(in);
                 }
-                const std::vector<Step> &chosen_move = found_moves[move_num];
+                const Move &chosen_move = found_moves[move_num];
                 std::cout << "Chosen move: ";
                 for (const Step &step : chosen_move) {
-                    std::cout << "(" << step.x << ", " << step.y << "){" << step.side_effect->get_name() << "}";
+                    std::cout << "(" << step.cell / env->board_size_y << ", " << step.cell % env->board_size_y << "){"
+                              << env->definition->side_effects[step.side_effect]->get_name() << "}";
                 }
                 std::cout << std::endl;
                 env->execute_move(chosen_move);
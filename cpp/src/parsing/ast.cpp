@@ -4,15 +4,16 @@
  */
 #include "ast.hpp"
 
-LetterNode::LetterNode(int dx, int dy, std::shared_ptr<Predicate> predicate, std::shared_ptr<SideEffect> side_effect)
+LetterNode::LetterNode(int dx, int dy, std::shared_ptr<const Predicate> predicate,
+                       std::shared_ptr<const SideEffect> side_effect)
     : dx(dx), dy(dy), predicate(predicate), side_effect(side_effect) {}
 LetterNode::~LetterNode() {}
 void LetterNode::accept(Visitor *visitor) {
     visitor->visitLetterNode(this);
 }
 
-MacroLetterNode::MacroLetterNode(std::string dx, std::string dy, std::shared_ptr<Predicate> predicate,
-                                 std::shared_ptr<SideEffect> side_effect)
+MacroLetterNode::MacroLetterNode(std::string dx, std::string dy, std::shared_ptr<const Predicate> predicate,
+                                 std::shared_ptr<const SideEffect> side_effect)
     : dx(dx), dy(dy), predicate(predicate), side_effect(side_effect) {}
 MacroLetterNode::~MacroLetterNode() {}
 void MacroLetterNode::accept(Visitor *visitor) {
@@ -83,7 +83,8 @@ class LetterNode : public Node
     /// @param dy the move's delta along the y axis.
     /// @param predicate a Predicate functor describing when the move is legal.
     /// @param side_effect a SideEffect functor describing the move's side effects.
-    LetterNode(int dx, int dy, std::shared_ptr<Predicate> predicate, std::shared_ptr<SideEffect> side_effect);
+    LetterNode(int dx, int dy, std::shared_ptr<const Predicate> predicate,
+               std::shared_ptr<const SideEffect> side_effect);
     ~LetterNode();
     void accept(Visitor *visitor) override;
     /// @brief the encoded move's delta along the x axis.
@@ -91,9 +92,9 @@ class LetterNode : public Node
     /// @brief the encoded move's delta along the y axis.
     int dy;
     /// @brief the encoded move's Predicate.
-    std::shared_ptr<Predicate> predicate;
+    std::shared_ptr<const Predicate> predicate;
     /// @brief the encoded move's SideEffect.
-    std::shared_ptr<SideEffect> side_effect;
+    std::shared_ptr<const SideEffect> side_effect;
 };
 
 /// @brief Node class to represent a macro'd regular expression letter.
@@ -123,8 +124,8 @@ class MacroLetterNode : public Node
     /// @param dy the move's delta along the y axis, possible parameterized.
     /// @param predicate a Predicate functor describing when the move is legal.
     /// @param side_effect a SideEffect functor describing the move's side effects.
-    MacroLetterNode(std::string dx, std::string dy, std::shared_ptr<Predicate> predicate,
-                    std::shared_ptr<SideEffect> side_effect);
+    MacroLetterNode(std::string dx, std::string dy, std::shared_ptr<const Predicate> predicate,
+                    std::shared_ptr<const SideEffect> side_effect);
     ~MacroLetterNode();
     void accept(Visitor *visitor) override;
     /// @brief the encoded move's delta along the x axis, possibly parameterized.
@@ -132,9 +133,9 @@ class MacroLetterNode : public Node
     /// @brief the encoded move's delta along the y axis, possibly parameterized.
     std::string dy;
     /// @brief the encoded move's Predicate.
-    std::shared_ptr<Predicate> predicate;
+    std::shared_ptr<const Predicate> predicate;
     /// @brief the encoded move's SideEffect.
-    std::shared_ptr<SideEffect> side_effect;
+    std::shared_ptr<const SideEffect> side_effect;
 };
 
 /// @brief Node class to represent concatenated regular expressions.
@@ -4,7 +4,8 @@
  */
 #include "parser.hpp"
 
-Parser::Parser(std::string file_path) : lexer(file_path), tokenTuple(lexer.next()), environment(nullptr) {}
+Parser::Parser(std::string file_path)
+    : lexer(file_path), tokenTuple(lexer.next()), border(0), definition(nullptr), definition_complete(false) {}
 Parser::~Parser() {}
 
 void Parser::parse() {
@@ -41,12 +42,64 @@ void Parser::parse() {
     match(Token::EOI);
 }
 
+std::shared_ptr<const GameDefinition> Parser::get_game_definition() {
+    if (definition_complete)
+        return definition;
+    int n_players = 0;
+    for (const std::string &player : players) {
+        definition->players.push_back(Symbols::get_player_id(player));
+        n_players = std::max(n_players, definition->players.back() + 1);
+    }
+    definition->pieces.resize(Symbols::get_piece_count());
+    for (auto &p : pieces) {
+        int piece = Symbols::get_piece_id(p.first);
+        definition->pieces[piece] = std::move(p.second);
+        definition->declared_pieces.push_back(piece);
+    }
+    definition->post_conditions.resize(n_players);
+    for (auto &p : post_conditions) {
+        int player = Symbols::get_player_id(p.first);
+        for (auto &post_condition : p.second) {
+            int piece = Symbols::get_piece_id(post_condition.first);
+            definition->post_conditions[player].push_back({piece, std::move(post_condition.second)});
+        }
+    }
+    definition->side_effects.resize(SideEffects::get_side_effect.size());
+    for (auto &p : SideEffects::get_side_effect) {
+        definition->side_effects.at(p.second->get_id()) = p.second.get();
+    }
+    definition->default_side_effect = SideEffects::get_side_effect.at("Default")->get_id();
+    for (int piece : definition->declared_pieces) {
+        DFAState *dfa = definition->pieces[piece].second.get();
+        if (dfa == nullptr)
+            continue;
+        int max_path_length = FATools::get_max_path_length(dfa, definition->board_size_x, definition->board_size_y);
+        if (max_path_length < 0 || max_path_length + 1 > Move::max_steps) {
+            std::ostringstream oss;
+            oss << "Moves of piece " << Symbols::get_piece_name(piece) << " can be ";
+            if (max_path_length < 0)
+                oss << "arbitrarily long";
+            else
+                oss << max_path_length + 1 << " steps long";
+            oss << " but at most " << Move::max_steps << " steps are supported"
+                << " (see ABG_MAX_MOVE_STEPS).";
+            std::string error_msg = oss.str();
+            throw std::runtime_error(error_msg);
+        }
+        definition->max_move_length = std::max(definition->max_move_length, max_path_length + 1);
+    }
+    definition->border = border;
+    definition->initial_board = board;
+    definition->set_transitions();
+    definition->set_zobrist_keys();
+    pieces.clear();
+    post_conditions.clear();
+    definition_complete = true;
+    return definition;
+}
+
 std::unique_ptr<Environment> Parser::get_environment() {
-    environment->players = players;
-    environment->current_player = players[0];
-    environment->pieces.merge(pieces);
-    environment->post_conditions.merge(post_conditions);
-    return std::move(environment);
+    return std::make_unique<Environment>(get_game_definition());
 }
 
 void Parser::match(Token token) {
@@ -82,6 +135,7 @@ void Parser::parse_player_list() {
         throw std::runtime_error(error_msg);
     }
     std::string player = parse_string();
+    Symbols::get_player_id(player);
     players.push_back(player);
     while (match_if(Token::Comma)) {
         Location loc = tokenTuple.location;
@@ -92,6 +146,7 @@ void Parser::parse_player_list() {
             std::string error_msg = oss.str();
             throw std::runtime_error(error_msg);
         }
+        Symbols::get_player_id(player);
         players.push_back(player);
     }
 }
@@ -120,8 +175,9 @@ void Parser::parse_piece() {
         std::string error_msg = oss.str();
         throw std::runtime_error(error_msg);
     }
+    Symbols::get_piece_id(piece);
     std::string player = "";
-    std::vector<std::string> owners;
+    unsigned int owners = 0;
     if (match_if(Token::LParen)) {
         loc = tokenTuple.location;
         player = parse_string();
@@ -131,7 +187,7 @@ void Parser::parse_piece() {
             std::string error_msg = oss.str();
             throw std::runtime_error(error_msg);
         }
-        owners.push_back(player);
+        owners |= 1u << Symbols::get_player_id(player);
         while (match_if(Token::Comma)) {
             loc = tokenTuple.location;
             player = parse_string();
@@ -141,13 +197,13 @@ void Parser::parse_piece() {
                 std::string error_msg = oss.str();
                 throw std::runtime_error(error_msg);
             }
-            if (std::find(owners.begin(), owners.end(), player) != owners.end()) {
+            if (owners & (1u << Symbols::get_player_id(player))) {
                 std::ostringstream oss;
                 oss << "Duplicate piece owner " << player << " in piece declaration in " << loc << ".";
                 std::string error_msg = oss.str();
                 throw std::runtime_error(error_msg);
             }
-            owners.push_back(player);
+            owners |= 1u << Symbols::get_player_id(player);
         }
         match(Token::RParen);
     }
@@ -157,7 +213,7 @@ void Parser::parse_piece() {
 void Parser::parse_board_size() {
     match(Token::BoardSize);
     match(Token::OpAssign);
-    if (environment != nullptr) {
+    if (definition != nullptr) {
         std::ostringstream oss;
         oss << "Redeclaration of board size in " << tokenTuple.location << ".";
         std::string error_msg = oss.str();
@@ -172,22 +228,21 @@ void Parser::parse_board_size() {
         std::string error_msg = oss.str();
         throw std::runtime_error(error_msg);
     }
-    environment = std::make_unique<Environment>(y, x);
+    definition = std::make_shared<GameDefinition>(y, x);
 }
 
 void Parser::parse_board() {
     match(Token::Board);
     match(Token::OpAssign);
-    if (environment == nullptr) {
+    if (definition == nullptr) {
         throw std::runtime_error("Board size must be declared before board.");
     }
-    if (!environment->board.empty()) {
+    if (!board.empty()) {
         std::ostringstream oss;
         oss << "Redeclaration of board in " << tokenTuple.location << ".";
         std::string error_msg = oss.str();
         throw std::runtime_error(error_msg);
     }
-    environment->board.resize(environment->board_size_x, std::vector<Cell>(environment->board_size_y, Cell()));
     Location loc = tokenTuple.location;
     std::string piece = parse_string();
     if (pieces.find(piece) == pieces.end()) {
@@ -196,19 +251,13 @@ void Parser::parse_board() {
         std::string error_msg = oss.str();
         throw std::runtime_error(error_msg);
     }
-    if (pieces[piece].second == nullptr && !pieces[piece].first.empty()) {
+    if (pieces[piece].second == nullptr && pieces[piece].first != 0) {
         std::ostringstream oss;
         oss << "Rule for piece " << piece << " must be declared before board declaration.";
         std::string error_msg = oss.str();
         throw std::runtime_error(error_msg);
     }
-    int board_size_x = environment->board_size_x;
-    int board_size_y = environment->board_size_y;
-    int cur_x = 0, cur_y = 0;
-    environment->board[cur_x][cur_y] = Cell(piece, pieces[piece].first, pieces[piece].second.get());
-    cur_x += ((cur_y + 1) / board_size_y);
-    cur_y = (cur_y + 1) % board_size_y;
-    int piece_count = 1;
+    board.push_back(Symbols::get_piece_id(piece));
     while (match_if(Token::Comma)) {
         loc = tokenTuple.location;
         piece = parse_string();
@@ -218,17 +267,17 @@ void Parser::parse_board() {
             std::string error_msg = oss.str();
             throw std::runtime_error(error_msg);
         }
-        if (pieces[piece].second == nullptr && !pieces[piece].first.empty()) {
+        if (pieces[piece].second == nullptr && pieces[piece].first != 0) {
             std::ostringstream oss;
             oss << "Rule for piece " << piece << " must be declared before board declaration.";
             std::string error_msg = oss.str();
             throw std::runtime_error(error_msg);
         }
-        environment->board[cur_x][cur_y] = Cell(piece, pieces[piece].first, pieces[piece].second.get());
-        cur_x += ((cur_y + 1) / board_size_y);
-        cur_y = (cur_y + 1) % board_size_y;
-        piece_count++;
+        board.push_back(Symbols::get_piece_id(piece));
     }
+    int board_size_x = definition->board_size_x;
+    int board_size_y = definition->board_size_y;
+    int piece_count = board.size();
     if (piece_count != board_size_x * board_size_y) {
         std::ostringstream oss;
         oss << "Invalid board declaration. Expected " << board_size_x * board_size_y << " pieces but got "
@@ -257,6 +306,7 @@ void Parser::parse_rule() {
     match(Token::OpAssign);
     std::unique_ptr<Node> node = parse_sentence();
     pieces[piece].second = FATools::getMinimizedDfa(node.get());
+    border = std::max(border, FATools::get_max_offset(pieces[piece].second.get()));
 }
 
 void Parser::parse_macro() {
@@ -328,6 +378,7 @@ void Parser::parse_post_condition() {
     match(Token::OpAssign);
     std::unique_ptr<Node> node = parse_sentence();
     post_conditions[player].push_back(std::make_pair(piece, FATools::getMinimizedDfa(node.get())));
+    border = std::max(border, FATools::get_max_offset(post_conditions[player].back().second.get()));
 }
 
 std::unique_ptr<Node> Parser::parse_macro_call(bool in_macro) {
@@ -435,8 +486,8 @@ std::unique_ptr<LetterNode> Parser::parse_letter() {
         throw std::runtime_error(error_msg);
     }
 
-    return std::make_unique<LetterNode>(dx, dy, Predicates::get_predicate[predicate_name],
-                                        SideEffects::get_side_effect[side_effect_name]);
+    return std::make_unique<LetterNode>(dx, dy, Predicates::get_predicate.at(predicate_name),
+                                        SideEffects::get_side_effect.at(side_effect_name));
 }
 
 std::unique_ptr<MacroLetterNode> Parser::parse_macro_letter() {
@@ -470,8 +521,8 @@ std::unique_ptr<MacroLetterNode> Parser::parse_macro_letter() {
         throw std::runtime_error(error_msg);
     }
 
-    return std::make_unique<MacroLetterNode>(dx, dy, Predicates::get_predicate[predicate_name],
-                                             SideEffects::get_side_effect[side_effect_name]);
+    return std::make_unique<MacroLetterNode>(dx, dy, Predicates::get_predicate.at(predicate_name),
+                                             SideEffects::get_side_effect.at(side_effect_name));
 }
 
 int Parser::parse_int() {
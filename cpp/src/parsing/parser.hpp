@@ -22,7 +22,8 @@
 
 /// @brief A class that parses a game description.
 /// @details
-///  Reads a tokenized game description and creates a game Environment from it.
+///  Reads a tokenized game description and creates a GameDefinition from it,
+///  from which any number of game Environment instances can be created.
 ///  To be used to Lexer.
 ///
 /// @see Lexer
@@ -42,15 +43,18 @@ class Parser
     ///  Resolves macros, creates state machines for each piece, and creates a
     ///  game Environment from the game description.
     void parse();
-    /// @brief Returns the parsed game environment.
-    ///
-    /// @note Since the Environment is returned as a std::unique_ptr this
-    ///  function can only be called once.
+    /// @brief Returns the parsed game definition.
+    /// @details
+    ///  The definition is built on the first call and shared by later calls.
     ///
     /// @note Calling this function also resets the Parser#pieces and
     ///  Parser#post_conditions variables.
     ///
-    /// @returns a pointer to the parsed game environment.
+    /// @returns a pointer to the parsed game definition.
+    std::shared_ptr<const GameDefinition> get_game_definition();
+    /// @brief Returns a new game environment in the initial state of the parsed game.
+    ///
+    /// @returns a pointer to a new game environment.
     std::unique_ptr<Environment> get_environment();
 
   private:
@@ -63,9 +67,10 @@ class Parser
     /// @brief The pieces defined in the game description, which player they
     ///  belong to, and how they can move.
     /// @details
-    ///  A map that takes a piece's name and returns a list of the players it
-    ///  belongs to, and a state machine to generate legal moves for it.
-    std::map<std::string, std::pair<std::vector<std::string>, std::unique_ptr<DFAState, DFAStateDeleter>>> pieces;
+    ///  A map that takes a piece's name and returns the set of players it
+    ///  belongs to (see Cell#owners), and a state machine to generate legal
+    ///  moves for it.
+    std::map<std::string, std::pair<unsigned int, std::unique_ptr<DFAState, DFAStateDeleter>>> pieces;
     /// @brief The macros defined in the game description, and the names of their arguments.
     /// @details
     ///  A map that takes a macro's name and returns the root of its abstract
@@ -87,10 +92,20 @@ class Parser
     ///  expression is not matched.
     std::map<std::string, std::vector<std::pair<std::string, std::unique_ptr<DFAState, DFAStateDeleter>>>>
         post_conditions;
-    /// @brief A pointer to the Environment parsed from the game description.
-    ///
-    /// @see Environment
-    std::unique_ptr<Environment> environment;
+    /// @brief The IDs of the pieces on the initial board declared in the game
+    ///  description in row-major order.
+    std::vector<int> board;
+    /// @brief The largest \p dx or \p dy used by any rule or post condition.
+    /// @details Determines the width of the sentinel border around the board.
+    ///
+    /// @see Environment#border
+    int border;
+    /// @brief A pointer to the GameDefinition parsed from the game description.
+    ///
+    /// @see GameDefinition
+    std::shared_ptr<GameDefinition> definition;
+    /// @brief True once Parser#definition is complete, see Parser::get_game_definition.
+    bool definition_complete;
     /// @brief Matches the next token in the token stream.
     ///
     /// @param token the Token to match.
@@ -109,7 +124,9 @@ class Parser
     bool match_if(Token token);
     /// @brief Extracts the player names declared in the game description.
     /// @details
-    ///  Stores the player names in Parser#players.
+    ///  Stores the player names in Parser#players and interns them.
+    ///
+    /// @see Symbols
     ///
     /// @warning Uses Token::match which can throw errors.
     /// @throw std::runtime_error if players have already been declared.
@@ -127,7 +144,9 @@ class Parser
     /// @brief Extracts a single piece and the player it belongs to from the
     ///  game description.
     /// @details
-    ///  Stores the information in Parser#pieces.
+    ///  Stores the information in Parser#pieces and interns the piece name.
+    ///
+    /// @see Symbols
     ///
     /// @warning Uses Token::match which can throw errors.
     /// @warning Uses Parser::parse_piece which can throw errors.
@@ -143,7 +162,7 @@ class Parser
     /// @brief Extracts the initial board configuration from the game
     ///  description.
     /// @details
-    ///  Stores the information in Parser#environment.
+    ///  Stores the information in Parser#board.
     ///
     /// @warning Uses Token::match which can throw errors.
     /// @throw std::runtime_error if the board size has not been declared.
@@ -7,42 +7,474 @@
  *  @brief A benchmarking tool using the perft measure.
  *  @author Bjarni Dagur Thor Kárason
  */
+#include "allocation_counter.hpp"
 #include "parser.hpp"
+#include "side_effects.hpp"
+#include "transposition_table.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <climits>
 #include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
 #include <random>
+#include <sstream>
 #include <string>
+#include <thread>
 
-long long state_cnt = 1;
+/// @brief True to count the states one ply from the frontier without visiting them.
+bool bulk_counting = false;
+/// @brief The smallest remaining depth whose subtree counts are cached.
+/// @details Shallower subtrees are cheaper to count than to look up.
+const int min_cached_depth = 2;
 
-void search(Environment *env, int depth) {
-    state_cnt++;
+/// @brief Searches the game tree from an Environment of its own and counts
+///  the states it visits.
+/// @details
+///  Every thread of the search has its own PerftSearcher, so nothing it
+///  touches while searching is shared with other threads.
+/// @author Bjarni Dagur Thor Kárason
+class PerftSearcher
+{
+  public:
+    /// @brief PerftSearcher constructor.
+    ///
+    /// @param definition the game to search.
+    /// @param depth the largest depth PerftSearcher::search is called with.
+    /// @param table the cache of subtree counts, or nullptr to count every subtree.
+    PerftSearcher(std::shared_ptr<const GameDefinition> definition, int depth, TranspositionTable *table)
+        : env(definition), table(table), move_buffers(depth + 1) {}
+    /// @brief The Environment to search from.
+    Environment env;
+    /// @brief The number of states visited so far, including the states of
+    ///  subtrees found in PerftSearcher#table.
+    long long state_cnt = 0;
+    /// @brief The number of subtree counts found in PerftSearcher#table.
+    long long table_hits = 0;
+    /// @brief The number of subtree counts looked up in PerftSearcher#table but not found.
+    long long table_misses = 0;
+    /// @brief Counts the states up to \p depth moves from the current state
+    ///  of PerftSearcher#env, including the current state.
+    /// @details
+    ///  The number of states below a state only depends on the state and the
+    ///  remaining depth, so if PerftSearcher#table is set the count is cached
+    ///  by Environment#hash and \p depth and each transposed subtree is only
+    ///  searched once.
+    void search(int depth) {
+        state_cnt++;
 
-    if (env->variables.game_over || depth == 0)
-        return;
+        if (env.variables.game_over || depth == 0)
+            return;
 
-    std::vector<std::vector<Step>> available_moves = env->generate_moves();
+        // Each legal move leads to exactly one state at the frontier.
+        if (bulk_counting && depth == 1) {
+            state_cnt += env.count_moves();
+            return;
+        }
 
-    for (const std::vector<Step> &move : available_moves) {
-        env->execute_move(move);
-        search(env, depth - 1);
-        env->undo_move();
+        bool cached = table != nullptr && depth >= min_cached_depth;
+        uint64_t key = cached ? table_key(depth) : 0;
+        if (cached) {
+            TranspositionTable::Entry entry;
+            if (table->probe(key, entry) && entry.depth == depth && entry.bound == TranspositionTable::Bound::Exact) {
+                table_hits++;
+                state_cnt += entry.value;
+                return;
+            }
+            table_misses++;
+        }
+
+        long long start_cnt = state_cnt;
+        std::vector<Move> &available_moves = move_buffers[depth];
+        env.generate_moves(available_moves);
+
+        for (const Move &move : available_moves) {
+            env.execute_move(move);
+            search(depth - 1);
+            env.undo_move();
+        }
+
+        long long subtree_cnt = state_cnt - start_cnt;
+        if (cached && subtree_cnt <= max_cached_count)
+            table->store(key, {subtree_cnt, depth, TranspositionTable::Bound::Exact, -1});
+    }
+    /// @brief Executes \p move, one of the \p n_moves legal moves of the
+    ///  current state, without generating the moves.
+    /// @details
+    ///  Sets Variables#n_moves_found first, the only state
+    ///  Environment::generate_moves leaves that executing a move depends on,
+    ///  so the Environment ends up exactly as in the search.
+    void execute_found_move(const Move &move, int n_moves) {
+        env.variables.n_moves_found = n_moves;
+        env.execute_move(move);
     }
+
+  private:
+    /// @brief The largest count a TranspositionTable::Entry can hold.
+    static constexpr long long max_cached_count = (1LL << 39) - 1;
+    /// @brief Returns the key of the current state at remaining depth \p depth in PerftSearcher#table.
+    /// @details
+    ///  Mixes the depth into the hash so the counts of one state at different
+    ///  depths do not replace each other.
+    uint64_t table_key(int depth) const {
+        return env.hash ^ (static_cast<uint64_t>(depth) * 0x9e3779b97f4a7c15ULL);
+    }
+    /// @brief The cache of subtree counts shared by all threads, or nullptr.
+    TranspositionTable *table;
+    /// @brief A move buffer for each remaining depth, reused across nodes so
+    ///  the search does not allocate once the buffers have grown.
+    std::vector<std::vector<Move>> move_buffers;
+};
+
+/// @brief A subtree of the game tree for a worker thread to count.
+struct PerftTask {
+    /// @brief The index of the move from the initial state in the root moves.
+    int root_move;
+    /// @brief The number of legal replies to PerftTask#root_move, or 0 to
+    ///  count the whole subtree of the root move.
+    int n_replies;
+    /// @brief The reply to PerftTask#root_move whose subtree to count.
+    /// @pre PerftTask#n_replies is not 0.
+    Move reply;
+};
+
+/// @brief What a worker thread counted.
+struct PerftCounts {
+    /// @brief The number of states below each root move.
+    std::vector<long long> divide;
+    /// @brief See PerftSearcher#table_hits.
+    long long table_hits = 0;
+    /// @brief See PerftSearcher#table_misses.
+    long long table_misses = 0;
+};
+
+/// @brief Counts the subtrees in \p tasks until none are left.
+/// @details
+///  Workers take the next task from the shared \p next_task cursor whenever
+///  they finish one, so a worker that got small subtrees keeps taking work
+///  while another is still busy with a large one.
+///
+/// @param definition the game to search.
+/// @param depth the depth of the whole search.
+/// @param root_moves the legal moves of the initial state.
+/// @param tasks the subtrees to count.
+/// @param next_task the index of the next task nobody has taken yet.
+/// @param table the cache of subtree counts, or nullptr.
+/// @param counts what the worker counted.
+void run_worker(std::shared_ptr<const GameDefinition> definition, int depth, const std::vector<Move> &root_moves,
+                const std::vector<PerftTask> &tasks, std::atomic<size_t> &next_task, TranspositionTable *table,
+                PerftCounts &counts) {
+    PerftSearcher searcher(definition, depth, table);
+    size_t i;
+    while ((i = next_task.fetch_add(1, std::memory_order_relaxed)) < tasks.size()) {
+        const PerftTask &task = tasks[i];
+        long long start_cnt = searcher.state_cnt;
+        searcher.execute_found_move(root_moves[task.root_move], root_moves.size());
+        if (task.n_replies == 0) {
+            searcher.search(depth - 1);
+        }
+        else {
+            searcher.execute_found_move(task.reply, task.n_replies);
+            searcher.search(depth - 2);
+            searcher.env.undo_move();
+        }
+        searcher.env.undo_move();
+        counts.divide[task.root_move] += searcher.state_cnt - start_cnt;
+    }
+    counts.table_hits = searcher.table_hits;
+    counts.table_misses = searcher.table_misses;
+}
+
+/// @brief Returns the text of \p move in \p env.
+/// @details
+///  The steps are written as "x,y" and separated by "-". A step whose side
+///  effect is not SideEffectId::Default is followed by the side effect's
+///  name in braces, e.g. "6,4-5,4-4,4{SetEnPassantable}". The text is
+///  used both to print moves and to read start positions in suites.
+std::string move_to_string(const Environment &env, const Move &move) {
+    std::ostringstream oss;
+    for (int i = 0; i < move.size(); i++) {
+        const Step &step = move[i];
+        if (i != 0)
+            oss << "-";
+        oss << step.cell / env.board_size_y << "," << step.cell % env.board_size_y;
+        if (step.side_effect != static_cast<int>(SideEffectId::Default))
+            oss << "{" << env.definition->side_effects[step.side_effect]->get_name() << "}";
+    }
+    return oss.str();
+}
+
+/// @brief A perft run in a suite, see run_suite.
+struct SuiteEntry {
+    /// @brief The line of the suite file the entry is on.
+    int line;
+    /// @brief The game description, as given in the suite file.
+    std::string game_file;
+    /// @brief The moves from the game's initial state to the start state, see move_to_string.
+    std::vector<std::string> moves;
+    /// @brief The depth to search to.
+    int depth;
+    /// @brief The expected number of states visited.
+    long long expected_cnt;
+    /// @brief The game, or nullptr if it could not be parsed.
+    std::shared_ptr<const GameDefinition> definition;
+    /// @brief The number of states visited.
+    long long state_cnt = 0;
+    /// @brief The running time of the entry in milliseconds.
+    double running_time = 0;
+    /// @brief Why the entry could not be run, or empty if it was run.
+    std::string error;
+};
+
+/// @brief Returns \p text without leading and trailing whitespace.
+std::string trim(const std::string &text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+/// @brief Reads the entries of a suite file.
+/// @details
+///  Each line holds one entry as four fields separated by ";": the game
+///  description, the moves leading to the start state separated by
+///  whitespace (empty for the game's initial state), the depth, and the
+///  expected number of states visited. Empty lines and lines starting with
+///  "#" are skipped. Game descriptions are relative to the suite file.
+///
+///  The predicates, side effects and terminal conditions are compiled into
+///  the binary, so a suite is only valid for a build with the actions of its
+///  games. Every game directory in games/ has its own actions, so all game
+///  descriptions of a suite must be in the same directory.
+///
+/// @throw std::runtime_error if the file can not be read, a line is
+///  malformed, or the game descriptions are in different directories.
+std::vector<SuiteEntry> read_suite(const std::string &suite_file) {
+    std::ifstream in(suite_file);
+    if (!in) {
+        throw std::runtime_error("Could not open suite file " + suite_file + ".");
+    }
+    std::filesystem::path suite_dir = std::filesystem::path(suite_file).parent_path();
+    std::vector<SuiteEntry> entries;
+    std::string text;
+    for (int line = 1; std::getline(in, text); line++) {
+        text = trim(text);
+        if (text.empty() || text[0] == '#')
+            continue;
+        std::vector<std::string> fields;
+        std::istringstream line_stream(text);
+        std::string field;
+        while (std::getline(line_stream, field, ';'))
+            fields.push_back(trim(field));
+        SuiteEntry entry;
+        entry.line = line;
+        try {
+            if (fields.size() != 4)
+                throw std::invalid_argument("expected 4 fields");
+            entry.game_file = (suite_dir / fields[0]).string();
+            std::istringstream move_stream(fields[1]);
+            std::string move;
+            while (move_stream >> move)
+                entry.moves.push_back(move);
+            entry.depth = std::stoi(fields[2]);
+            entry.expected_cnt = std::stoll(fields[3]);
+            if (entry.depth < 1 || entry.expected_cnt < 0)
+                throw std::invalid_argument("negative number");
+        } catch (const std::logic_error &) {
+            std::ostringstream oss;
+            oss << "Malformed entry on line " << line << " of " << suite_file
+                << ", expected <gamefile>; <moves>; <depth>; <count>.";
+            throw std::runtime_error(oss.str());
+        }
+        std::filesystem::path game_dir = std::filesystem::path(entry.game_file).parent_path();
+        if (!entries.empty() && game_dir != std::filesystem::path(entries.front().game_file).parent_path()) {
+            std::ostringstream oss;
+            oss << "Game on line " << line << " of " << suite_file << " is not in the same directory as the game on line "
+                << entries.front().line << ", but a suite can only hold games that share their actions.";
+            throw std::runtime_error(oss.str());
+        }
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+/// @brief Runs the entries of a suite until none are left.
+/// @details Takes entries from the shared \p next_entry cursor like run_worker takes tasks.
+void run_suite_worker(std::vector<SuiteEntry> &entries, std::atomic<size_t> &next_entry) {
+    size_t i;
+    while ((i = next_entry.fetch_add(1, std::memory_order_relaxed)) < entries.size()) {
+        SuiteEntry &entry = entries[i];
+        if (entry.definition == nullptr)
+            continue;
+        auto start_time = std::chrono::steady_clock::now();
+        PerftSearcher searcher(entry.definition, entry.depth, nullptr);
+        std::vector<Move> found_moves;
+        for (const std::string &text : entry.moves) {
+            searcher.env.generate_moves(found_moves);
+            auto move = std::find_if(found_moves.begin(), found_moves.end(), [&](const Move &found_move) {
+                return move_to_string(searcher.env, found_move) == text;
+            });
+            if (move == found_moves.end()) {
+                entry.error = "move " + text + " is not legal";
+                break;
+            }
+            searcher.env.execute_move(*move);
+        }
+        if (!entry.error.empty())
+            continue;
+        searcher.search(entry.depth);
+        auto end_time = std::chrono::steady_clock::now();
+        entry.state_cnt = searcher.state_cnt;
+        entry.running_time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    }
+}
+
+/// @brief Runs the perft suite in \p suite_file on \p n_threads threads and
+///  prints the result of each entry and the aggregate throughput.
+///
+/// @returns EXIT_SUCCESS if every entry visited the expected number of states.
+int run_suite(const std::string &suite_file, int n_threads) {
+    std::vector<SuiteEntry> entries = read_suite(suite_file);
+
+    // Games are parsed once, up front, and shared by their entries.
+    std::map<std::string, std::shared_ptr<const GameDefinition>> definitions;
+    std::map<std::string, std::string> parse_errors;
+    for (SuiteEntry &entry : entries) {
+        if (definitions.count(entry.game_file) == 0 && parse_errors.count(entry.game_file) == 0) {
+            try {
+                Parser parser(entry.game_file);
+                parser.parse();
+                definitions[entry.game_file] = parser.get_game_definition();
+            } catch (const std::exception &e) {
+                parse_errors[entry.game_file] = e.what();
+            }
+        }
+        if (definitions.count(entry.game_file) != 0)
+            entry.definition = definitions[entry.game_file];
+        else
+            entry.error = parse_errors[entry.game_file];
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::atomic<size_t> next_entry(0);
+    std::vector<std::thread> workers;
+    for (int t = 1; t < n_threads; t++)
+        workers.emplace_back(run_suite_worker, std::ref(entries), std::ref(next_entry));
+    run_suite_worker(entries, next_entry);
+    for (std::thread &worker : workers)
+        worker.join();
+    auto end_time = std::chrono::steady_clock::now();
+
+    int n_failed = 0;
+    long long state_cnt = 0;
+    for (const SuiteEntry &entry : entries) {
+        std::cout << suite_file << ":" << entry.line << ": " << entry.game_file << " depth " << entry.depth << ": ";
+        if (!entry.error.empty()) {
+            n_failed++;
+            std::cout << "ERROR " << entry.error << std::endl;
+            continue;
+        }
+        state_cnt += entry.state_cnt;
+        if (entry.state_cnt != entry.expected_cnt) {
+            n_failed++;
+            std::cout << "MISMATCH " << entry.state_cnt << " states, expected " << entry.expected_cnt;
+        }
+        else {
+            std::cout << "OK " << entry.state_cnt << " states";
+        }
+        double states_per_s = entry.running_time > 0 ? entry.state_cnt / entry.running_time * 1000 : 0;
+        std::cout << std::fixed << std::setprecision(2) << ", " << entry.running_time << " ms, "
+                  << std::setprecision(0) << states_per_s << " states/s" << std::endl;
+    }
+    double running_time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    std::cout << "Entries: " << entries.size() << std::endl;
+    std::cout << "Failed entries: " << n_failed << std::endl;
+    std::cout << std::setprecision(2) << "Running time (ms): " << running_time << std::endl;
+    std::cout << "Number of states visited: " << state_cnt << std::endl;
+    std::cout << std::setprecision(0) << "States/s: " << (running_time > 0 ? state_cnt / running_time * 1000 : 0) << std::endl;
+    std::cout << "Threads: " << n_threads << std::endl;
+
+    return n_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /// @brief Takes an Abstract Boardgame description and a depth to compute the
 ///  game tree to. Prints relevant statistics.
+/// @details
+///  With --bulk, the states at the frontier are counted without executing
+///  the moves that lead to them.
+///
+///  With --threads N, the subtrees below the initial state are counted by N
+///  threads with an Environment each. Root moves with deep enough subtrees
+///  are split further into one task per reply, so the work is spread evenly
+///  even if a few root moves have most of the states below them.
+///
+///  With --hash MB, the number of states below each state is cached by the
+///  state and remaining depth in a transposition table of the given size,
+///  shared by all threads, so transposed subtrees are only searched once.
+///  Environment#hash leaves out the Variables a game's side effects do not
+///  hash, e.g. the stagnation counter of chess. The counts are exact as long
+///  as those Variables do not change the game within the search, e.g. no
+///  searched path reaches the 50-move rule.
+///
+///  Prints the number of states below each root move, including the state
+///  it leads to.
+///
+///  With --suite, runs the entries of a suite file instead, see read_suite,
+///  on as many threads as there are cores unless --threads is given, and
+///  reports the entries that did not visit the expected number of states.
 /// @author Bjarni Dagur Thor Kárason
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <gamefile> <depth>" << std::endl;
+    const char *usage = " <gamefile> <depth> [--bulk] [--threads N] [--hash MB]";
+    const char *suite_usage = " --suite <suitefile> [--bulk] [--threads N]";
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << usage << std::endl;
+        std::cerr << "       " << argv[0] << suite_usage << std::endl;
         return EXIT_FAILURE;
     }
+    bool suite = std::strcmp(argv[1], "--suite") == 0;
+    int n_threads = suite ? std::max(std::thread::hardware_concurrency(), 1u) : 1;
+    int hash_mb = 0;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--bulk") == 0) {
+            bulk_counting = true;
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            n_threads = std::stoi(argv[++i]);
+            if (n_threads < 1) {
+                std::cerr << "The number of threads must be positive" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strcmp(argv[i], "--hash") == 0 && i + 1 < argc && !suite) {
+            hash_mb = std::stoi(argv[++i]);
+            if (hash_mb < 1) {
+                std::cerr << "The hash table size must be positive" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0] << usage << std::endl;
+            std::cerr << "       " << argv[0] << suite_usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (suite) {
+        try {
+            return run_suite(argv[2], n_threads);
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
     int depth = std::stoi(argv[2]);
     assert(depth > 0);
@@ -52,28 +484,85 @@ int main(int argc, char *argv[]) {
 
     Parser parser(argv[1]);
     parser.parse();
-    std::unique_ptr<Environment> env = parser.get_environment();
+    std::shared_ptr<const GameDefinition> definition = parser.get_game_definition();
+    std::unique_ptr<TranspositionTable> table;
+    if (hash_mb > 0)
+        table = std::make_unique<TranspositionTable>(hash_mb);
+    std::unique_ptr<Environment> env = std::make_unique<Environment>(definition);
 
+    long long start_allocations = AllocationCounter::get_count();
     auto start_time = std::chrono::system_clock::now();
 
-    std::vector<std::vector<Step>> found_moves = env->generate_moves();
-    for (const std::vector<Step> &move : found_moves) {
-        env->execute_move(move);
-        search(env.get(), depth - 1);
+    std::vector<Move> found_moves = env->generate_moves();
+    std::vector<long long> divide(found_moves.size(), 0);
+    // The replies are generated here once and handed to the workers, which
+    // only execute the two moves leading to their subtree.
+    std::vector<PerftTask> tasks;
+    std::vector<Move> replies;
+    for (int i = 0; i < (int)found_moves.size(); i++) {
+        // Splitting only pays off if the replies have subtrees of their own.
+        if (depth < 3) {
+            tasks.push_back({i, 0, Move()});
+            continue;
+        }
+        env->execute_move(found_moves[i]);
+        divide[i]++;
+        if (!env->variables.game_over) {
+            env->generate_moves(replies);
+            for (const Move &reply : replies)
+                tasks.push_back({i, (int)replies.size(), reply});
+        }
         env->undo_move();
     }
 
+    std::atomic<size_t> next_task(0);
+    std::vector<PerftCounts> thread_counts(n_threads);
+    for (PerftCounts &counts : thread_counts)
+        counts.divide.assign(found_moves.size(), 0);
+    std::vector<std::thread> workers;
+    for (int t = 1; t < n_threads; t++)
+        workers.emplace_back(run_worker, definition, depth, std::cref(found_moves), std::cref(tasks),
+                             std::ref(next_task), table.get(), std::ref(thread_counts[t]));
+    run_worker(definition, depth, found_moves, tasks, next_task, table.get(), thread_counts[0]);
+    for (std::thread &worker : workers)
+        worker.join();
+
+    long long state_cnt = 1;
+    long long table_hits = 0, table_misses = 0;
+    for (const PerftCounts &counts : thread_counts) {
+        for (size_t i = 0; i < divide.size(); i++)
+            divide[i] += counts.divide[i];
+        table_hits += counts.table_hits;
+        table_misses += counts.table_misses;
+    }
+    for (long long subtree_cnt : divide)
+        state_cnt += subtree_cnt;
+
     if (!found_moves.empty()) {
         std::uniform_int_distribution<int> uni(0, found_moves.size() - 1);
-        const std::vector<Step> &chosen_move = found_moves[uni(rng)];
+        const Move &chosen_move = found_moves[uni(rng)];
         env->execute_move(chosen_move);
     }
 
     auto end_time = std::chrono::system_clock::now();
+    long long n_allocations = AllocationCounter::get_count() - start_allocations;
     double running_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+    for (size_t i = 0; i < found_moves.size(); i++)
+        std::cout << move_to_string(*env, found_moves[i]) << ": " << divide[i] << std::endl;
     std::cout << "Running time (ms): " << running_time << std::endl;
     std::cout << "Number of states visited: " << state_cnt << std::endl;
     std::cout << std::fixed << "States/s: " << state_cnt / running_time * 1000 << std::endl;
+    std::cout << "Threads: " << n_threads << std::endl;
+    if (table) {
+        std::cout << "Hash table entries: " << table->get_capacity() << std::endl;
+        std::cout << "Hash table hits: " << table_hits << std::endl;
+        std::cout << "Hash table misses: " << table_misses << std::endl;
+        std::cout << "Hash table hit rate: " << 100.0 * table_hits / std::max(table_hits + table_misses, 1LL) << "%"
+                  << std::endl;
+    }
+    std::cout << "Heap allocations: " << n_allocations << std::endl;
+    std::cout << "Move generator: " << (env->definition->move_generator != nullptr ? "compiled" : "interpreted")
+              << std::endl;
 
     return EXIT_SUCCESS;
 }
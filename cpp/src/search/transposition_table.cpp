@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+#include "transposition_table.hpp"
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Layout of a packed payload. The top bit is always set so an empty slot,
+// where both words are 0, never matches.
+static const int value_bits = 40;
+static const int depth_shift = 40;
+static const int best_move_shift = 48;
+static const int bound_shift = 56;
+static const int generation_shift = 58;
+static const uint64_t generation_mask = 0x1f;
+static const uint64_t occupied_bit = uint64_t(1) << 63;
+static const int no_best_move = 0xff;
+// Transparent huge pages are 2 MB on the platforms we run on.
+static const size_t huge_page_size = 2 * 1024 * 1024;
+
+TranspositionTable::TranspositionTable(size_t size_mb, ReplacementPolicy policy, bool huge_pages)
+    : buckets(nullptr), mask(0), policy(policy), generation(0) {
+    if (size_mb == 0) {
+        throw std::runtime_error("Transposition table size must be at least 1 MB.");
+    }
+    size_t n_buckets = 1;
+    while (n_buckets * 2 * sizeof(Bucket) <= size_mb * 1024 * 1024) {
+        n_buckets *= 2;
+    }
+    size_t n_bytes = n_buckets * sizeof(Bucket);
+    mask = n_buckets - 1;
+
+    // The table size is a power of two, so it is a multiple of the huge page
+    // size whenever it is at least one huge page.
+    size_t alignment = huge_pages && n_bytes >= huge_page_size ? huge_page_size : alignof(Bucket);
+    buckets = static_cast<Bucket *>(std::aligned_alloc(alignment, n_bytes));
+    if (buckets == nullptr) {
+        std::ostringstream oss;
+        oss << "Failed to allocate a " << size_mb << " MB transposition table.";
+        std::string error_msg = oss.str();
+        throw std::runtime_error(error_msg);
+    }
+#ifdef MADV_HUGEPAGE
+    if (alignment == huge_page_size)
+        madvise(buckets, n_bytes, MADV_HUGEPAGE);
+#endif
+    for (size_t i = 0; i < n_buckets; i++) {
+        new (&buckets[i]) Bucket();
+    }
+    clear();
+}
+
+TranspositionTable::~TranspositionTable() {
+    std::free(buckets);
+}
+
+bool TranspositionTable::probe(uint64_t hash, Entry &entry) const {
+    const Bucket &bucket = buckets[hash & mask];
+    for (const Slot &slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) == hash && (data & occupied_bit)) {
+            entry = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t hash, const Entry &entry) {
+    Bucket &bucket = buckets[hash & mask];
+    Slot *victim = nullptr;
+    int victim_age = -1, victim_depth = 0;
+    for (Slot &slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if (!(data & occupied_bit) || (check ^ data) == hash) {
+            victim = &slot;
+            victim_age = generation_mask + 1;
+            break;
+        }
+        int age = (generation - generation_of(data)) & generation_mask;
+        int depth = depth_of(data);
+        if (age > victim_age || (age == victim_age && depth < victim_depth)) {
+            victim = &slot;
+            victim_age = age;
+            victim_depth = depth;
+        }
+    }
+    if (policy == ReplacementPolicy::DepthPreferred && victim_age == 0 && entry.depth < victim_depth)
+        return;
+
+    uint64_t data = pack(entry);
+    victim->check.store(hash ^ data, std::memory_order_relaxed);
+    victim->data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= mask; i++) {
+        for (Slot &slot : buckets[i].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::new_search() {
+    generation = (generation + 1) & generation_mask;
+}
+
+size_t TranspositionTable::get_capacity() const {
+    return (mask + 1) * bucket_size;
+}
+
+uint64_t TranspositionTable::pack(const Entry &entry) const {
+    int best_move = entry.best_move < 0 || entry.best_move >= no_best_move ? no_best_move : entry.best_move;
+    uint64_t data = static_cast<uint64_t>(entry.value) & ((uint64_t(1) << value_bits) - 1);
+    data |= static_cast<uint64_t>(static_cast<uint8_t>(entry.depth)) << depth_shift;
+    data |= static_cast<uint64_t>(best_move) << best_move_shift;
+    data |= static_cast<uint64_t>(entry.bound) << bound_shift;
+    data |= static_cast<uint64_t>(generation) << generation_shift;
+    return data | occupied_bit;
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(uint64_t data) {
+    Entry entry;
+    // Sign-extend the value from 40 bits.
+    entry.value = static_cast<int64_t>(data << (64 - value_bits)) >> (64 - value_bits);
+    entry.depth = depth_of(data);
+    int best_move = (data >> best_move_shift) & 0xff;
+    entry.best_move = best_move == no_best_move ? -1 : best_move;
+    entry.bound = static_cast<Bound>((data >> bound_shift) & 0x3);
+    return entry;
+}
+
+uint8_t TranspositionTable::generation_of(uint64_t data) {
+    return (data >> generation_shift) & generation_mask;
+}
+
+int TranspositionTable::depth_of(uint64_t data) {
+    return static_cast<int8_t>((data >> depth_shift) & 0xff);
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+/**
+ *  @file transposition_table.hpp
+ *  @brief A fixed-size transposition table that can be shared between threads.
+ *  @author Bjarni Dagur Thor Kárason
+ *  @see Environment#hash
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief A fixed-size hash table that caches search results by position hash.
+/// @details
+///  The table is an array of 64 byte buckets, each holding
+///  TranspositionTable::bucket_size entries, so a probe touches a single cache
+///  line. A position's bucket is chosen by the low bits of its hash.
+///
+///  The table can be probed and stored to from several threads without locks.
+///  Each entry is stored as two 64-bit words, the packed payload and the hash
+///  XOR-ed with the payload. A probe only returns an entry if XOR-ing the two
+///  words gives back the hash, so an entry torn by concurrent writes is
+///  treated as a miss instead of being returned with the wrong payload.
+///
+///  The payload is generic enough for perft, alpha-beta search and MCTS: a
+///  depth, a bound type, a value and the index of the best move.
+///
+/// @see Environment#hash
+///
+/// @author Bjarni Dagur Thor Kárason
+class TranspositionTable
+{
+  public:
+    /// @brief What TranspositionTable::Entry#value means.
+    enum class Bound : uint8_t {
+        /// @brief The value is not meaningful, e.g. only the best move is stored.
+        None,
+        /// @brief The value is exact, e.g. a perft node count or a minimax value.
+        Exact,
+        /// @brief The value is a lower bound, e.g. after a beta cutoff.
+        Lower,
+        /// @brief The value is an upper bound, e.g. after failing low.
+        Upper,
+    };
+    /// @brief Which entry a store replaces when a bucket is full.
+    /// @details
+    ///  An entry for the same hash is always overwritten. Otherwise the
+    ///  victim is the entry from the oldest search, and among those the one
+    ///  with the lowest depth.
+    enum class ReplacementPolicy {
+        /// @brief Always overwrite the victim.
+        Always,
+        /// @brief Only overwrite the victim if it is from an older search or
+        ///  the new entry is at least as deep.
+        DepthPreferred,
+    };
+    /// @brief A search result.
+    struct Entry {
+        /// @brief The value of the position, e.g. a node count or a score.
+        /// @details Must fit in a 40-bit signed integer.
+        int64_t value;
+        /// @brief The remaining search depth the value was computed with.
+        /// @details Must fit in an 8-bit signed integer.
+        int depth;
+        /// @brief What Entry#value means.
+        Bound bound;
+        /// @brief The index of the best move in the generated move list, or -1 if unknown.
+        /// @details Indices above 254 are stored as -1.
+        int best_move;
+    };
+    /// @brief The number of entries in a bucket.
+    static constexpr int bucket_size = 4;
+    /// @brief TranspositionTable constructor.
+    /// @details
+    ///  The number of buckets is rounded down to a power of two.
+    ///
+    /// @param size_mb the size of the table in megabytes.
+    /// @param policy which entry to replace when a bucket is full.
+    /// @param huge_pages true to align the table to huge pages and ask the
+    ///  operating system to back it with transparent huge pages. Ignored
+    ///  where unsupported or if the table is smaller than a huge page.
+    ///
+    /// @throw std::runtime_error if \p size_mb is 0 or the table can not be allocated.
+    TranspositionTable(size_t size_mb, ReplacementPolicy policy = ReplacementPolicy::DepthPreferred,
+                       bool huge_pages = false);
+    /// @brief TranspositionTable destructor.
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+    /// @brief Looks up the entry for a position.
+    ///
+    /// @param hash the position's hash.
+    /// @param entry set to the stored entry if found.
+    ///
+    /// @returns true if an entry for \p hash was found.
+    /// @returns false otherwise.
+    bool probe(uint64_t hash, Entry &entry) const;
+    /// @brief Stores the entry for a position, subject to the replacement policy.
+    ///
+    /// @param hash the position's hash.
+    /// @param entry the entry to store.
+    void store(uint64_t hash, const Entry &entry);
+    /// @brief Removes all entries.
+    /// @warning Not safe to call while other threads use the table.
+    void clear();
+    /// @brief Marks the start of a new search.
+    /// @details
+    ///  Entries from earlier searches are replaced before entries from the
+    ///  current one.
+    ///
+    /// @warning Not safe to call while other threads use the table.
+    void new_search();
+    /// @brief Returns the number of entries the table can hold.
+    size_t get_capacity() const;
+
+  private:
+    /// @brief An entry stored as its payload and the hash XOR-ed with the payload.
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+    /// @brief A cache line of slots.
+    struct alignas(64) Bucket {
+        Slot slots[bucket_size];
+    };
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+    /// @brief Packs an entry and the current search generation into a payload.
+    uint64_t pack(const Entry &entry) const;
+    /// @brief Unpacks a payload into an entry.
+    static Entry unpack(uint64_t data);
+    /// @brief Returns the search generation a payload was stored in.
+    static uint8_t generation_of(uint64_t data);
+    /// @brief Returns the depth a payload was stored with.
+    static int depth_of(uint64_t data);
+    /// @brief The buckets.
+    Bucket *buckets;
+    /// @brief The number of buckets minus one, used to map hashes to buckets.
+    size_t mask;
+    /// @brief Which entry to replace when a bucket is full.
+    ReplacementPolicy policy;
+    /// @brief The current search generation, wrapping around at 32.
+    uint8_t generation;
+};
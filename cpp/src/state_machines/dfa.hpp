@@ -39,7 +39,7 @@ class DFAInput
     /// @param dy the move's delta along the y axis.
     /// @param predicate a Predicate functor describing when the move is legal.
     /// @param side_effect a SideEffect functor describing the move's side effects.
-    DFAInput(int dx, int dy, std::shared_ptr<Predicate> predicate, std::shared_ptr<SideEffect> side_effect);
+    DFAInput(int dx, int dy, std::shared_ptr<const Predicate> predicate, std::shared_ptr<const SideEffect> side_effect);
     /// @brief DFAInput destructor.
     ~DFAInput();
     /// @brief Defines ordering for DFAInput.
@@ -58,9 +58,9 @@ class DFAInput
     /// @brief the encoded move's delta along the y axis.
     int dy;
     /// @brief the encoded move's Predicate.
-    std::shared_ptr<Predicate> predicate;
+    std::shared_ptr<const Predicate> predicate;
     /// @brief the encoded move's SideEffect.
-    std::shared_ptr<SideEffect> side_effect;
+    std::shared_ptr<const SideEffect> side_effect;
 };
 
 /// @brief Class to represent a node in a NFA.
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+#include "dfa_table.hpp"
+#include "predicates.hpp"
+#include "side_effects.hpp"
+
+DFATable::DFATable() : accepting(1, false), edge_begin({0, 0}), n_cells(0) {}
+
+int DFATable::add_dfa(const DFAState *initial_state) {
+    if (initial_state == nullptr)
+        return 0;
+    // Number the states in BFS order, so the states of a DFA are close together.
+    std::map<const DFAState *, int> index;
+    std::vector<const DFAState *> states;
+    std::queue<const DFAState *> q;
+    index[initial_state] = size();
+    states.push_back(initial_state);
+    q.push(initial_state);
+    while (!q.empty()) {
+        const DFAState *at = q.front();
+        q.pop();
+        for (const auto &p : at->transition) {
+            const DFAState *next_state = p.second;
+            if (index.find(next_state) == index.end()) {
+                index[next_state] = size() + states.size();
+                states.push_back(next_state);
+                q.push(next_state);
+            }
+        }
+    }
+    for (const DFAState *state : states) {
+        for (const auto &p : state->transition) {
+            const DFAInput &input = p.first;
+            if (input.dx != static_cast<int8_t>(input.dx) || input.dy != static_cast<int8_t>(input.dy)) {
+                std::string error_msg = "Offsets in a DFA transition must be between -128 and 127.";
+                throw std::runtime_error(error_msg);
+            }
+            edges.push_back({index[p.second], static_cast<int8_t>(input.dx), static_cast<int8_t>(input.dy),
+                             static_cast<uint8_t>(input.predicate->get_id()),
+                             static_cast<uint8_t>(input.side_effect->get_id())});
+        }
+        accepting.push_back(state->is_accepting);
+        edge_begin.push_back(edges.size());
+    }
+    return index[initial_state];
+}
+
+void DFATable::set_board(int board_size_x, int board_size_y) {
+    n_cells = board_size_x * board_size_y;
+    if (n_cells > UINT16_MAX + 1) {
+        std::ostringstream oss;
+        oss << "Boards with more than " << UINT16_MAX + 1 << " cells are not supported.";
+        std::string error_msg = oss.str();
+        throw std::runtime_error(error_msg);
+    }
+    offsets.clear();
+    for (const DFAEdge &edge : edges) {
+        if (offset_index(edge.dx, edge.dy) == -1)
+            offsets.push_back({edge.dx, edge.dy});
+    }
+    offset_targets.assign(n_cells * offsets.size(), off_board);
+    for (int x = 0; x < board_size_x; x++) {
+        for (int y = 0; y < board_size_y; y++) {
+            for (int offset = 0; offset < n_offsets(); offset++) {
+                int next_x = x - offsets[offset].second;
+                int next_y = y + offsets[offset].first;
+                if (next_x >= 0 && next_x < board_size_x && next_y >= 0 && next_y < board_size_y)
+                    offset_targets[(x * board_size_y + y) * offsets.size() + offset] = next_x * board_size_y + next_y;
+            }
+        }
+    }
+    // Only self-loops that slide a piece over empty cells without doing
+    // anything else are followed as rays, other edges keep the generic walk.
+    auto empty = Predicates::get_predicate.find("Empty");
+    int empty_predicate = empty != Predicates::get_predicate.end() ? empty->second->get_id() : -1;
+    int default_side_effect = SideEffects::get_side_effect.at("Default")->get_id();
+    auto is_ray = [&](const DFAEdge &edge, int state) {
+        return edge.target == state && (edge.dx != 0 || edge.dy != 0) && edge.predicate == empty_predicate &&
+               edge.side_effect == default_side_effect;
+    };
+    ray_edges.assign(size(), -1);
+    ray_offsets.assign(size(), -1);
+    square_edge_begin.assign(1, 0);
+    square_edges.clear();
+    for (int state = 0; state < size(); state++) {
+        std::vector<int> edge_offsets;
+        for (const DFAEdge *edge = begin(state); edge != end(state); edge++) {
+            edge_offsets.push_back(offset_index(edge->dx, edge->dy));
+            if (is_ray(*edge, state) && ray_edges[state] == -1) {
+                ray_edges[state] = edge - edges.data();
+                ray_offsets[state] = edge_offsets.back();
+            }
+        }
+        for (int square = 0; square < n_cells; square++) {
+            for (int i = 0; i < end(state) - begin(state); i++) {
+                const DFAEdge &edge = begin(state)[i];
+                if (&edge == ray(state))
+                    continue;
+                int next_square = offset_target(square, edge_offsets[i]);
+                if (next_square == off_board)
+                    continue;
+                square_edges.push_back(
+                    {edge.target, static_cast<uint16_t>(next_square), edge.predicate, edge.side_effect});
+            }
+            square_edge_begin.push_back(square_edges.size());
+        }
+    }
+}
+
+int DFATable::offset_index(int dx, int dy) const {
+    for (int i = 0; i < n_offsets(); i++) {
+        if (offsets[i].first == dx && offsets[i].second == dy)
+            return i;
+    }
+    return -1;
+}
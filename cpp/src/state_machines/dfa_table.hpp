@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
+ */
+/**
+ *  @file dfa_table.hpp
+ *  @brief Flattened, read-only tables of DFA transitions used for move generation.
+ *  @author Bjarni Dagur Thor Kárason
+ *  @see dfa.hpp
+ */
+#pragma once
+
+#include "dfa.hpp"
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <utility>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+/// @brief An edge in a DFATable.
+/// @details
+///  The flattened form of a DFAInput and its destination state.
+///
+/// @see DFAInput
+///
+/// @author Bjarni Dagur Thor Kárason
+struct DFAEdge {
+    /// @brief The index of the destination state in the DFATable.
+    int32_t target;
+    /// @brief The move's delta along the x axis.
+    int8_t dx;
+    /// @brief The move's delta along the y axis.
+    int8_t dy;
+    /// @brief The ID of the edge's Predicate.
+    ///
+    /// @see Predicates::evaluate
+    uint8_t predicate;
+    /// @brief The ID of the edge's SideEffect.
+    ///
+    /// @see SideEffects::execute
+    uint8_t side_effect;
+};
+
+/// @brief An edge in a DFATable that is taken from a particular square.
+/// @details
+///  A DFAEdge whose destination has been resolved for the square it is taken
+///  from, so following it needs neither offset arithmetic nor a bounds check.
+///
+/// @see DFATable::begin(int, int)
+///
+/// @author Bjarni Dagur Thor Kárason
+struct SquareEdge {
+    /// @brief The index of the destination state in the DFATable.
+    int32_t target;
+    /// @brief The square the edge leads to, see Environment::square.
+    uint16_t next_square;
+    /// @brief The ID of the edge's Predicate.
+    ///
+    /// @see Predicates::evaluate
+    uint8_t predicate;
+    /// @brief The ID of the edge's SideEffect.
+    ///
+    /// @see SideEffects::execute
+    uint8_t side_effect;
+};
+
+/// @brief Any number of DFAs stored as flat arrays.
+/// @details
+///  States are identified by their index. The edges leaving each state are
+///  stored contiguously, in the order of DFAState::transition, so state \p s
+///  has the edges in [DFATable::begin(s), DFATable::end(s)). Move generation
+///  walks these arrays instead of following pointers through the nodes of
+///  DFAState::transition.
+///
+///  State 0 is a dead state without edges, for pieces that have no DFA.
+///
+///  Once all DFAs have been added, DFATable::set_board resolves the offsets
+///  of the edges for every square of the board. Move generation then walks
+///  only the edges that stay on the board from the square it is at.
+///
+///  An edge from a state back to itself with a non-zero offset, the Empty
+///  predicate and the Default side effect, such as the edges of
+///  `[dx, dy, Empty]*`, is a ray: taking it repeatedly slides a piece along a
+///  line. DFATable::set_board leaves rays out of the per-square edge lists
+///  so move generation can follow them in a loop, see DFATable::ray. Other
+///  self-loops stay in the per-square edge lists.
+///
+/// @see DFAState
+///
+/// @author Bjarni Dagur Thor Kárason
+class DFATable
+{
+  public:
+    /// @brief DFATable constructor.
+    /// @details Creates a table holding only the dead state.
+    DFATable();
+    /// @brief Adds all states reachable from a DFA state to the table.
+    ///
+    /// @param initial_state the initial state of the DFA to add, or nullptr.
+    ///
+    /// @returns the index of \p initial_state in the table, or 0 if it is nullptr.
+    int add_dfa(const DFAState *initial_state);
+    /// @brief Returns the number of states in the table.
+    int size() const {
+        return accepting.size();
+    }
+    /// @brief Returns true if \p state is an accepting state.
+    bool is_accepting(int state) const {
+        return accepting[state];
+    }
+    /// @brief Returns a pointer to the first edge leaving \p state.
+    const DFAEdge *begin(int state) const {
+        return edges.data() + edge_begin[state];
+    }
+    /// @brief Returns a pointer past the last edge leaving \p state.
+    const DFAEdge *end(int state) const {
+        return edges.data() + edge_begin[state + 1];
+    }
+    /// @brief The square of DFATable::offset_target for offsets that leave the board.
+    static constexpr int off_board = -1;
+    /// @brief Resolves the offsets of all edges for every square of a board.
+    /// @details
+    ///  Builds the tables behind DFATable::offset_target and
+    ///  DFATable::begin(int, int). Must be called again if more DFAs are added.
+    ///
+    /// @param board_size_x the board's size along the x axis.
+    /// @param board_size_y the board's size along the y axis.
+    ///
+    /// @throw std::runtime_error if the board has too many cells for a SquareEdge.
+    void set_board(int board_size_x, int board_size_y);
+    /// @brief Returns the ray of \p state, or nullptr if it has none.
+    /// @details
+    ///  The ray is the first edge leaving \p state that leads back to it with
+    ///  a non-zero offset, the Empty predicate and the Default side effect.
+    ///
+    /// @pre DFATable::set_board has been called.
+    const DFAEdge *ray(int state) const {
+        return ray_edges[state] == -1 ? nullptr : edges.data() + ray_edges[state];
+    }
+    /// @brief Returns the index of the offset of the ray of \p state, see DFATable::ray.
+    ///
+    /// @pre \p state has a ray.
+    int ray_offset(int state) const {
+        return ray_offsets[state];
+    }
+    /// @brief Returns true if no edge can be taken from \p state at \p square.
+    /// @details
+    ///  A move that reaches such a state is complete, so no predicate of the
+    ///  piece's DFA reads the board after its last step. Post conditions may
+    ///  still read it, see Environment::accept_final_step.
+    ///
+    /// @pre DFATable::set_board has been called.
+    bool is_final(int state, int square) const {
+        return begin(state, square) == end(state, square) &&
+               (ray_edges[state] == -1 || offset_target(square, ray_offsets[state]) == off_board);
+    }
+    /// @brief Returns the number of distinct offsets of the edges.
+    int n_offsets() const {
+        return offsets.size();
+    }
+    /// @brief Returns the index of offset (\p dx, \p dy), or -1 if no edge has it.
+    int offset_index(int dx, int dy) const;
+    /// @brief Returns the square reached by moving from \p square by an offset.
+    ///
+    /// @param square the square to move from, see Environment::square.
+    /// @param offset the index of the offset, see DFATable::offset_index.
+    ///
+    /// @returns the square moved to, or DFATable::off_board if it is not on the board.
+    ///
+    /// @pre DFATable::set_board has been called.
+    int offset_target(int square, int offset) const {
+        return offset_targets[square * offsets.size() + offset];
+    }
+    /// @brief Returns a pointer to the first edge leaving \p state that stays
+    ///  on the board when taken from \p square, other than its ray.
+    ///
+    /// @pre DFATable::set_board has been called.
+    const SquareEdge *begin(int state, int square) const {
+        return square_edges.data() + square_edge_begin[state * n_cells + square];
+    }
+    /// @brief Returns a pointer past the last edge leaving \p state that stays
+    ///  on the board when taken from \p square, other than its ray.
+    ///
+    /// @pre DFATable::set_board has been called.
+    const SquareEdge *end(int state, int square) const {
+        return square_edges.data() + square_edge_begin[state * n_cells + square + 1];
+    }
+
+  private:
+    /// @brief Whether each state is accepting, indexed by state.
+    std::vector<uint8_t> accepting;
+    /// @brief The index in DFATable#edges of the first edge leaving each
+    ///  state, followed by the total number of edges.
+    std::vector<int> edge_begin;
+    /// @brief The edges of all states, grouped by the state they leave.
+    std::vector<DFAEdge> edges;
+    /// @brief The number of cells on the board passed to DFATable::set_board.
+    int n_cells;
+    /// @brief The distinct offsets (dx, dy) of the edges.
+    std::vector<std::pair<int, int>> offsets;
+    /// @brief The square reached from each square by each offset, indexed
+    ///  by square times DFATable::n_offsets plus the offset's index.
+    std::vector<int> offset_targets;
+    /// @brief The index in DFATable#edges of the ray of each state, or -1 if it has none.
+    std::vector<int> ray_edges;
+    /// @brief The index of the offset of the ray of each state, or -1 if it has none.
+    std::vector<int> ray_offsets;
+    /// @brief The index in DFATable#square_edges of the first edge of each
+    ///  state taken from each square, indexed by state times the number of
+    ///  cells plus the square, followed by the total number of edges.
+    std::vector<int> square_edge_begin;
+    /// @brief The edges of all states from all squares, grouped by state and
+    ///  then by square.
+    std::vector<SquareEdge> square_edges;
+};
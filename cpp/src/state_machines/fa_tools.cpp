@@ -3,6 +3,9 @@
  *  Copyright (C) 2022 Bjarni Dagur Thor Kárason <bjarni@bjarnithor.com>
  */
 #include "fa_tools.hpp"
+#include <cstdlib>
+#include <map>
+#include <tuple>
 
 std::set<DFAState *> FATools::get_all_states(DFAState *initial_state) {
     std::set<DFAState *> vis;
@@ -45,6 +48,57 @@ std::set<NFAState *> FATools::get_all_states(NFAState *initial_state) {
     return vis;
 }
 
+int FATools::get_max_offset(DFAState *initial_state) {
+    int max_offset = 0;
+    for (DFAState *state : get_all_states(initial_state)) {
+        for (const auto &p : state->transition) {
+            const DFAInput &input = p.first;
+            max_offset = std::max({max_offset, std::abs(input.dx), std::abs(input.dy)});
+        }
+    }
+    return max_offset;
+}
+
+// Returns the largest number of transitions from state at (x, y), or -1 if
+// unbounded. Positions on the current path are marked with -2 in memo.
+static int get_max_path_length(DFAState *state, int x, int y, int board_size_x, int board_size_y,
+                               std::map<std::tuple<DFAState *, int, int>, int> &memo) {
+    auto key = std::make_tuple(state, x, y);
+    auto it = memo.find(key);
+    if (it != memo.end())
+        return it->second == -2 ? -1 : it->second;
+    memo[key] = -2;
+    int max_path_length = 0;
+    for (const auto &p : state->transition) {
+        int next_x = x - p.first.dy;
+        int next_y = y + p.first.dx;
+        if (next_x < 0 || next_x >= board_size_x || next_y < 0 || next_y >= board_size_y)
+            continue;
+        int path_length = get_max_path_length(p.second, next_x, next_y, board_size_x, board_size_y, memo);
+        if (path_length < 0) {
+            max_path_length = -1;
+            break;
+        }
+        max_path_length = std::max(max_path_length, path_length + 1);
+    }
+    memo[key] = max_path_length;
+    return max_path_length;
+}
+
+int FATools::get_max_path_length(DFAState *initial_state, int board_size_x, int board_size_y) {
+    std::map<std::tuple<DFAState *, int, int>, int> memo;
+    int max_path_length = 0;
+    for (int x = 0; x < board_size_x; x++) {
+        for (int y = 0; y < board_size_y; y++) {
+            int path_length = ::get_max_path_length(initial_state, x, y, board_size_x, board_size_y, memo);
+            if (path_length < 0)
+                return -1;
+            max_path_length = std::max(max_path_length, path_length);
+        }
+    }
+    return max_path_length;
+}
+
 void FATools::to_dot(DFAState *initial_state, std::string output_path) {
     std::ofstream output_file;
     output_file.open(output_path);
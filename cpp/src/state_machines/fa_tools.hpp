@@ -43,6 +43,25 @@ std::set<DFAState *> get_all_states(DFAState *initial_state);
 ///
 /// @returns the set of reachable states from \p initial_state.
 std::set<NFAState *> get_all_states(NFAState *initial_state);
+/// @brief Finds the largest absolute \p dx or \p dy on any transition in a DFA.
+///
+/// @param initial_state the initial state of the DFA.
+///
+/// @returns the largest absolute \p dx or \p dy over all transitions reachable from \p initial_state.
+int get_max_offset(DFAState *initial_state);
+/// @brief Finds the largest number of transitions a piece can make on a board.
+/// @details
+///  Follows the DFA's transitions from every cell of an empty board of the
+///  given size, ignoring predicates, and only as long as the piece stays on
+///  the board.
+///
+/// @param initial_state the initial state of the DFA.
+/// @param board_size_x the board's size along the x axis.
+/// @param board_size_y the board's size along the y axis.
+///
+/// @returns the largest number of transitions from \p initial_state, or -1 if
+///  the DFA can loop forever without leaving the board.
+int get_max_path_length(DFAState *initial_state, int board_size_x, int board_size_y);
 /// @brief Writes a DFA as a dot graph to a file.
 ///
 /// @param initial_state the initial state of a DFA to convert to dot format.
@@ -58,9 +58,9 @@ class NFAInput
     /// @brief the encoded move's delta along the y axis.
     int dy;
     /// @brief the encoded move's Predicate.
-    std::shared_ptr<Predicate> predicate;
+    std::shared_ptr<const Predicate> predicate;
     /// @brief the encoded move's SideEffect.
-    std::shared_ptr<SideEffect> side_effect;
+    std::shared_ptr<const SideEffect> side_effect;
     /// @brief if true then the edge is an epsilon-transition, else it is a Letter transition.
     bool is_epsilon;
 };